@@ -0,0 +1,399 @@
+/**
+ * A benchmark for the CPU side of the render path of the scenegraph.
+ *
+ * It builds a synthetic scenegraph which resembles a busy session (many workspaces, views with subsurfaces
+ * and chains of transformers) and measures the scenegraph helpers which run on every frame. The leaf nodes
+ * do not issue any GL calls, so that the benchmark measures the scenegraph itself and can run without a
+ * compositor instance or a GPU.
+ */
+#include <wayfire/scene.hpp>
+#include <wayfire/scene-render.hpp>
+#include <wayfire/view-transform.hpp>
+#include <wayfire/util.hpp>
+#include <wayfire/util/log.hpp>
+#include <wayland-server-core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct benchmark_config_t
+{
+    int workspaces = 9;
+    int views_per_workspace = 40;
+    int layers     = 200;
+    int subsurfaces_per_view = 2;
+    int transformer_depth    = 3;
+    // Every n-th view gets a transformer chain
+    int transformer_every    = 4;
+    int iterations = 500;
+    wf::dimensions_t output_size = {1920, 1080};
+};
+
+// Prevent the compiler from optimizing away the benchmarked work.
+uint64_t painted_pixels = 0;
+
+class bench_surface_node_t : public wf::scene::node_t
+{
+  public:
+    bench_surface_node_t(wf::geometry_t geometry, bool opaque) : node_t(false)
+    {
+        this->geometry = geometry;
+        this->opaque   = opaque;
+    }
+
+    void gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+        wf::scene::damage_callback push_damage, wf::output_t *output) override;
+
+    wf::geometry_t get_bounding_box() override
+    {
+        return geometry;
+    }
+
+    wf::geometry_t geometry;
+    bool opaque;
+};
+
+class bench_surface_render_instance_t : public wf::scene::simple_render_instance_t<bench_surface_node_t>
+{
+  public:
+    using simple_render_instance_t::simple_render_instance_t;
+
+    void render(const wf::render_target_t& target, const wf::region_t& region) override
+    {
+        for (const auto& rect : region)
+        {
+            painted_pixels += (rect.x2 - rect.x1) * (rect.y2 - rect.y1);
+        }
+    }
+
+    wf::scene::direct_scanout try_scanout(wf::output_t *output) override
+    {
+        return wf::scene::direct_scanout::OCCLUSION;
+    }
+
+    void compute_visibility(wf::output_t *output, wf::region_t& visible) override
+    {
+        if (self->opaque)
+        {
+            visible ^= self->get_bounding_box();
+        }
+    }
+};
+
+void bench_surface_node_t::gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+    wf::scene::damage_callback push_damage, wf::output_t *output)
+{
+    instances.push_back(std::make_unique<bench_surface_render_instance_t>(this, push_damage, output));
+}
+
+class bench_transformer_node_t : public wf::scene::transformer_base_node_t
+{
+  public:
+    bench_transformer_node_t() : transformer_base_node_t(false)
+    {}
+
+    void gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+        wf::scene::damage_callback push_damage, wf::output_t *output) override;
+};
+
+/**
+ * Emulates a transformer which renders its children to an auxiliary buffer: the children are rendered in a
+ * nested render pass, but without the GL work.
+ */
+class bench_transformer_render_instance_t :
+    public wf::scene::transformer_render_instance_t<bench_transformer_node_t>
+{
+  public:
+    using transformer_render_instance_t::transformer_render_instance_t;
+
+    void render(const wf::render_target_t& target, const wf::region_t& region) override
+    {
+        wf::scene::render_pass_params_t params;
+        params.instances = &children;
+        params.target    = target;
+        params.damage    = region;
+        wf::scene::run_render_pass(params, 0);
+    }
+};
+
+void bench_transformer_node_t::gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+    wf::scene::damage_callback push_damage, wf::output_t *output)
+{
+    instances.push_back(std::make_unique<bench_transformer_render_instance_t>(this, push_damage, output));
+}
+
+/**
+ * Build a view: a surface root with the main surface and its subsurfaces, optionally wrapped in a chain of
+ * transformers.
+ */
+wf::scene::node_ptr build_view(const benchmark_config_t& config, wf::geometry_t geometry, bool transformed)
+{
+    auto surface_root = std::make_shared<wf::scene::floating_inner_node_t>(false);
+    std::vector<wf::scene::node_ptr> surfaces;
+    for (int i = 0; i < config.subsurfaces_per_view; i++)
+    {
+        wf::geometry_t sub = {geometry.x + 10 * (i + 1), geometry.y + 10 * (i + 1), 64, 64};
+        surfaces.push_back(std::make_shared<bench_surface_node_t>(sub, false));
+    }
+
+    surfaces.push_back(std::make_shared<bench_surface_node_t>(geometry, true));
+    surface_root->set_children_list(surfaces);
+
+    wf::scene::node_ptr top = surface_root;
+    if (transformed)
+    {
+        for (int i = 0; i < config.transformer_depth; i++)
+        {
+            auto tr = std::make_shared<bench_transformer_node_t>();
+            tr->set_children_list({top});
+            top = tr;
+        }
+    }
+
+    return top;
+}
+
+wf::scene::floating_inner_ptr build_scene(const benchmark_config_t& config)
+{
+    auto root = std::make_shared<wf::scene::floating_inner_node_t>(true);
+    std::vector<wf::scene::floating_inner_ptr> layers;
+    for (int i = 0; i < config.layers; i++)
+    {
+        layers.push_back(std::make_shared<wf::scene::floating_inner_node_t>(false));
+    }
+
+    const int total_views = config.workspaces * config.views_per_workspace;
+    std::vector<std::vector<wf::scene::node_ptr>> layer_children(config.layers);
+    for (int i = 0; i < total_views; i++)
+    {
+        const int ws = i / config.views_per_workspace;
+        const int idx_on_ws = i % config.views_per_workspace;
+
+        // Cascade views on their workspace so that they partially overlap.
+        wf::geometry_t geometry;
+        geometry.width  = config.output_size.width / 2;
+        geometry.height = config.output_size.height / 2;
+        geometry.x = ws * config.output_size.width + (idx_on_ws * 37) % (config.output_size.width / 2);
+        geometry.y = (idx_on_ws * 23) % (config.output_size.height / 2);
+
+        const bool transformed = (config.transformer_every > 0) && (i % config.transformer_every == 0);
+        layer_children[i % config.layers].push_back(build_view(config, geometry, transformed));
+    }
+
+    std::vector<wf::scene::node_ptr> root_children;
+    for (int i = 0; i < config.layers; i++)
+    {
+        layers[i]->set_children_list(layer_children[i]);
+        root_children.push_back(layers[i]);
+    }
+
+    root->set_children_list(root_children);
+    return root;
+}
+
+struct benchmark_result_t
+{
+    std::string name;
+    std::vector<double> samples_us;
+};
+
+benchmark_result_t run_benchmark(const std::string& name, int iterations, const std::function<void()>& fn)
+{
+    benchmark_result_t result;
+    result.name = name;
+    result.samples_us.reserve(iterations);
+
+    // Warm up caches and allocators
+    for (int i = 0; i < std::min(iterations, 10); i++)
+    {
+        fn();
+    }
+
+    for (int i = 0; i < iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        result.samples_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    return result;
+}
+
+void print_result(benchmark_result_t result)
+{
+    auto& s = result.samples_us;
+    std::sort(s.begin(), s.end());
+
+    double mean = 0;
+    for (auto x : s)
+    {
+        mean += x;
+    }
+
+    mean /= std::max<size_t>(1, s.size());
+    auto percentile = [&] (double p) { return s.empty() ? 0.0 : s[std::min(s.size() - 1, size_t(p * s.size()))]; };
+
+    printf("%-36s %10.2f %10.2f %10.2f %10.2f\n", result.name.c_str(),
+        mean, percentile(0.5), percentile(0.95), s.empty() ? 0.0 : s.front());
+}
+
+void print_usage()
+{
+    std::cout << "Usage: render-pass-benchmark [options]\n"
+              << "  -w, --workspaces N            number of workspaces (default 9)\n"
+              << "  -v, --views N                 views per workspace (default 40)\n"
+              << "  -l, --layers N                number of floating inner layers (default 200)\n"
+              << "  -s, --subsurfaces N           subsurfaces per view (default 2)\n"
+              << "  -t, --transformer-depth N     length of transformer chains (default 3)\n"
+              << "  -e, --transformer-every N     every N-th view is transformed, 0 for none (default 4)\n"
+              << "  -i, --iterations N            iterations per benchmark (default 500)\n";
+}
+}
+
+int main(int argc, char **argv)
+{
+    benchmark_config_t config;
+
+    static struct option opts[] = {
+        {"workspaces", required_argument, NULL, 'w'},
+        {"views", required_argument, NULL, 'v'},
+        {"layers", required_argument, NULL, 'l'},
+        {"subsurfaces", required_argument, NULL, 's'},
+        {"transformer-depth", required_argument, NULL, 't'},
+        {"transformer-every", required_argument, NULL, 'e'},
+        {"iterations", required_argument, NULL, 'i'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, NULL, 0}
+    };
+
+    int c, i;
+    while ((c = getopt_long(argc, argv, "w:v:l:s:t:e:i:h", opts, &i)) != -1)
+    {
+        switch (c)
+        {
+          case 'w':
+            config.workspaces = std::max(1, atoi(optarg));
+            break;
+
+          case 'v':
+            config.views_per_workspace = std::max(1, atoi(optarg));
+            break;
+
+          case 'l':
+            config.layers = std::max(1, atoi(optarg));
+            break;
+
+          case 's':
+            config.subsurfaces_per_view = std::max(0, atoi(optarg));
+            break;
+
+          case 't':
+            config.transformer_depth = std::max(0, atoi(optarg));
+            break;
+
+          case 'e':
+            config.transformer_every = std::max(0, atoi(optarg));
+            break;
+
+          case 'i':
+            config.iterations = std::max(1, atoi(optarg));
+            break;
+
+          default:
+            print_usage();
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    wf::log::initialize_logging(std::cout, wf::log::LOG_LEVEL_ERROR, wf::log::LOG_COLOR_MODE_OFF);
+    // Signals use safe_list_t which needs wl_idle_call to be usable.
+    wf::wl_idle_call::loop = wl_event_loop_create();
+
+    auto root = build_scene(config);
+    auto no_damage = [] (const wf::region_t&) {};
+
+    std::vector<wf::scene::render_instance_uptr> instances;
+    root->gen_render_instances(instances, no_damage, nullptr);
+
+    wf::render_target_t target;
+    target.geometry = {0, 0, config.output_size.width, config.output_size.height};
+    target.viewport_width  = config.output_size.width;
+    target.viewport_height = config.output_size.height;
+
+    const wf::region_t full_damage{target.geometry};
+    const wf::region_t small_damage{wf::geometry_t{100, 100, 32, 16}};
+
+    printf("%d workspaces, %d views per workspace, %d layers, %d subsurfaces per view, "
+           "transformer chains of %d on every %d-th view\n\n",
+        config.workspaces, config.views_per_workspace, config.layers, config.subsurfaces_per_view,
+        config.transformer_depth, config.transformer_every);
+    printf("%-36s %10s %10s %10s %10s\n", "benchmark (us)", "mean", "median", "p95", "min");
+
+    std::vector<benchmark_result_t> results;
+    results.push_back(run_benchmark("gen_render_instances", config.iterations, [&] ()
+    {
+        std::vector<wf::scene::render_instance_uptr> tmp;
+        root->gen_render_instances(tmp, no_damage, nullptr);
+    }));
+
+    auto gather = [&] (const wf::region_t& damage)
+    {
+        return [&] ()
+        {
+            wf::region_t dmg = damage;
+            std::vector<wf::scene::render_instruction_t> instructions;
+            for (auto& inst : instances)
+            {
+                inst->schedule_instructions(instructions, target, dmg);
+            }
+        };
+    };
+
+    results.push_back(run_benchmark("schedule_instructions (full)", config.iterations, gather(full_damage)));
+    results.push_back(run_benchmark("schedule_instructions (small)", config.iterations, gather(small_damage)));
+
+    auto render_pass = [&] (const wf::region_t& damage)
+    {
+        return [&] ()
+        {
+            wf::scene::render_pass_params_t params;
+            params.instances = &instances;
+            params.target    = target;
+            params.damage    = damage;
+            wf::scene::run_render_pass(params, 0);
+        };
+    };
+
+    results.push_back(run_benchmark("run_render_pass (full)", config.iterations, render_pass(full_damage)));
+    results.push_back(run_benchmark("run_render_pass (small)", config.iterations, render_pass(small_damage)));
+
+    results.push_back(run_benchmark("compute_visibility_from_list", config.iterations, [&] ()
+    {
+        wf::region_t visible = target.geometry;
+        wf::scene::compute_visibility_from_list(instances, nullptr, visible, {0, 0});
+    }));
+
+    results.push_back(run_benchmark("try_scanout_from_list", config.iterations, [&] ()
+    {
+        wf::scene::try_scanout_from_list(instances, nullptr);
+    }));
+
+    for (auto& r : results)
+    {
+        print_result(r);
+    }
+
+    instances.clear();
+    root.reset();
+    wl_event_loop_destroy(wf::wl_idle_call::loop);
+    return 0;
+}
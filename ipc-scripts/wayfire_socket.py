@@ -50,10 +50,25 @@ class WayfireSocket:
     def close(self):
       self.client.close()
 
-    def watch(self, events = None):
+    def watch(self, events = None, coalesce = None, interval = None, view_ids = None, app_ids = None):
         message = get_msg_template("window-rules/events/watch")
         if events:
             message["data"]["events"] = events
+        if coalesce is not None:
+            message["data"]["coalesce"] = coalesce
+        if interval is not None:
+            message["data"]["interval"] = interval
+        if view_ids:
+            message["data"]["view-ids"] = view_ids
+        if app_ids:
+            message["data"]["app-ids"] = app_ids
+        return self.send_json(message)
+
+    def batch(self, calls, atomic = False):
+        # calls is a list of (method, data) pairs
+        message = get_msg_template("ipc/batch")
+        message["data"]["calls"] = [{"method": method, "data": data} for method, data in calls]
+        message["data"]["atomic"] = atomic
         return self.send_json(message)
 
     def query_output(self, output_id: int):
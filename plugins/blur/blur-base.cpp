@@ -218,8 +218,51 @@ static wf::pointf_t get_center(wf::geometry_t g)
     return {g.x + g.width / 2.0, g.y + g.height / 2.0};
 }
 
+wlr_box wf_blur_base::calculate_blur_box(const wf::render_target_t& target_fb, wlr_box geometry)
+{
+    auto box        = target_fb.framebuffer_box_from_geometry_box(geometry);
+    auto source_box = target_fb.framebuffer_box_from_geometry_box(target_fb.geometry);
+    return sanitize(box, degrade_opt, source_box);
+}
+
+void wf_blur_base::store_prepared_blur(wf::framebuffer_t& cache, wlr_box cache_box,
+    const wf::region_t& fb_region)
+{
+    const int degrade = degrade_opt;
+    OpenGL::render_begin();
+    cache.allocate(std::max(1, cache_box.width / degrade), std::max(1, cache_box.height / degrade));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, fb[0].fb));
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cache.fb));
+
+    // Both buffers are stored upside down (GL convention) and degraded, so the boxes to copy have to be
+    // aligned to the degraded pixels and flipped.
+    auto prepared_region = fb_region & prepared_geometry & cache_box;
+    for (auto& b : prepared_region)
+    {
+        auto box = sanitize(wlr_box_from_pixman_box(b), degrade, prepared_geometry);
+        const int src_x  = (box.x - prepared_geometry.x) / degrade;
+        const int src_y  = (prepared_geometry.y + prepared_geometry.height - box.y - box.height) / degrade;
+        const int dst_x  = (box.x - cache_box.x) / degrade;
+        const int dst_y  = (cache_box.y + cache_box.height - box.y - box.height) / degrade;
+        const int width  = box.width / degrade;
+        const int height = box.height / degrade;
+
+        GL_CALL(glBlitFramebuffer(src_x, src_y, src_x + width, src_y + height,
+            dst_x, dst_y, dst_x + width, dst_y + height, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+    }
+
+    OpenGL::render_end();
+}
+
 void wf_blur_base::render(wf::texture_t src_tex, wlr_box src_box, const wf::region_t& damage,
     const wf::render_target_t& background_source_fb, const wf::render_target_t& target_fb)
+{
+    render(src_tex, src_box, damage, background_source_fb, target_fb, fb[0], prepared_geometry);
+}
+
+void wf_blur_base::render(wf::texture_t src_tex, wlr_box src_box, const wf::region_t& damage,
+    const wf::render_target_t& background_source_fb, const wf::render_target_t& target_fb,
+    const wf::framebuffer_t& background, wlr_box background_box)
 {
     OpenGL::render_begin(target_fb);
     blend_program.use(src_tex.type);
@@ -253,8 +296,8 @@ void wf_blur_base::render(wf::texture_t src_tex, wlr_box src_box, const wf::regi
     // 3. Scale to match the view size
     // 4. Translate to match the view
     auto view_box    = background_source_fb.framebuffer_box_from_geometry_box(src_box); // Projected view
-    auto blurred_box = prepared_geometry;
-    // prepared_geometry is the projected damage bounding box
+    auto blurred_box = background_box;
+    // background_box is the projected bounding box of the blurred background
 
     glm::mat4 fb_fix   = target_fb.transform;
     const auto scale_x = 1.0 * view_box.width / blurred_box.width;
@@ -277,7 +320,7 @@ void wf_blur_base::render(wf::texture_t src_tex, wlr_box src_box, const wf::regi
 
     blend_program.set_active_texture(src_tex);
     GL_CALL(glActiveTexture(GL_TEXTURE0 + 1));
-    GL_CALL(glBindTexture(GL_TEXTURE_2D, fb[0].tex));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, background.tex));
     /* Render it to target_fb */
     target_fb.bind();
 
@@ -10,6 +10,7 @@
 #include <wayfire/workspace-set.hpp>
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/bindings-repository.hpp>
+#include <wayfire/render-manager.hpp>
 
 #include "blur.hpp"
 #include "wayfire/core.hpp"
@@ -99,12 +100,130 @@ class blur_node_t : public transformer_base_node_t
     }
 };
 
+/**
+ * The blur render instance keeps a cache of the blurred background of its view on the output it is shown on.
+ *
+ * The cache is invalidated by damage on the output which does not come from the view itself, expanded by the
+ * blur radius. When only the view changes (for example, a translucent terminal where text is typed), the
+ * background does not need to be blurred again and is taken from the cache. Otherwise, only the invalidated
+ * parts of the cache are blurred again.
+ */
 class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
 {
     blur_node_t::saved_pixels_t *saved_pixels = nullptr;
 
+    struct cache_key_t
+    {
+        wf::geometry_t target_geometry;
+        wf::geometry_t bounding_box;
+        float scale;
+        wl_output_transform transform;
+        wf_blur_base *algorithm;
+        int radius;
+
+        bool operator ==(const cache_key_t& other) const
+        {
+            return (target_geometry == other.target_geometry) && (bounding_box == other.bounding_box) &&
+                   (scale == other.scale) && (transform == other.transform) &&
+                   (algorithm == other.algorithm) && (radius == other.radius);
+        }
+    };
+
+    std::optional<cache_key_t> cache_key;
+    // Whether the cache is used in the current render pass
+    bool cache_used = false;
+    wf::framebuffer_t cache;
+    wlr_box cache_box;
+    // The parts of the view, in logical coordinates, whose blurred background in the cache is up-to-date.
+    wf::region_t cache_valid;
+    // The parts which will be blurred again and stored in the cache by the next render() call.
+    wf::region_t cache_missing;
+    // Damage on the output since the last frame which did not come from the view itself.
+    wf::region_t background_damage;
+    // Set while damage from the view itself is pushed to the output, which happens synchronously.
+    bool pushing_self_damage = false;
+
+    wf::signal::connection_t<wf::output_damage_signal> on_output_damage = [=] (wf::output_damage_signal *ev)
+    {
+        if (pushing_self_damage)
+        {
+            return;
+        }
+
+        // Only damage up to a blur radius away from the view changes its blurred background. Clip the rest,
+        // so that the region stays small while the view is not rendered.
+        const int padding = std::ceil(self->provider()->calculate_blur_radius() / _shown_on->handle->scale);
+        wf::region_t affected{self->get_bounding_box()};
+        affected.expand_edges(padding);
+        background_damage |= ev->region & affected;
+    };
+
+    /**
+     * Check whether the cache can be used for rendering to @target, and drop its contents if it was filled
+     * for a different target, view geometry or blur algorithm.
+     */
+    bool prepare_cache(const wf::render_target_t& target)
+    {
+        if (!_shown_on || target.subbuffer)
+        {
+            return false;
+        }
+
+        // The cache is tracked in output-local coordinates, so it can only be used when rendering the view
+        // directly to the output.
+        if (target.geometry != _shown_on->get_relative_geometry())
+        {
+            return false;
+        }
+
+        cache_key_t key{
+            .target_geometry = target.geometry,
+            .bounding_box    = self->get_bounding_box(),
+            .scale           = target.scale,
+            .transform       = target.wl_transform,
+            .algorithm       = self->provider().get(),
+            .radius          = self->provider()->calculate_blur_radius(),
+        };
+
+        if (!cache_key || !(*cache_key == key))
+        {
+            cache_key = key;
+            cache_box = self->provider()->calculate_blur_box(target, key.bounding_box);
+            cache_valid.clear();
+        }
+
+        return true;
+    }
+
   public:
-    using transformer_render_instance_t::transformer_render_instance_t;
+    blur_render_instance_t(blur_node_t *self, damage_callback push_damage, wf::output_t *shown_on) :
+        transformer_render_instance_t(self, push_damage, shown_on)
+    {
+        if (shown_on)
+        {
+            shown_on->connect(&on_output_damage);
+        }
+
+        // Mark the damage of the view's contents, so that it is not mistaken for background damage.
+        auto push_damage_output = std::move(_push_damage);
+        _push_damage = [=] (const wf::region_t& region)
+        {
+            pushing_self_damage = true;
+            push_damage_output(region);
+            pushing_self_damage = false;
+        };
+    }
+
+    ~blur_render_instance_t()
+    {
+        if (cache.fb != uint32_t(-1))
+        {
+            OpenGL::render_begin();
+            cache.release();
+            OpenGL::render_end();
+        }
+    }
+
     bool is_fully_opaque(wf::region_t damage)
     {
         if (self->get_children().size() == 1)
@@ -164,6 +283,32 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
             return;
         }
 
+        cache_missing.clear();
+        cache_used = prepare_cache(target);
+        if (cache_used)
+        {
+            // A change in the background affects the blurred background up to a blur radius away.
+            background_damage.expand_edges(padding);
+            cache_valid ^= background_damage;
+            background_damage.clear();
+
+            auto needs_blur = calculate_translucent_damage(target, padded_region & target.geometry);
+            cache_missing = needs_blur ^ cache_valid;
+            if (cache_missing.empty())
+            {
+                // The whole blurred background is in the cache, nothing needs to be blurred.
+                instructions.push_back(render_instruction_t{
+                            .instance = this,
+                            .target   = target,
+                            .damage   = padded_region & target.geometry,
+                        });
+                return;
+            }
+
+            // Blur again only what is missing from the cache.
+            padded_region = cache_missing;
+        }
+
         padded_region.expand_edges(padding);
         padded_region &= bbox;
 
@@ -173,7 +318,7 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
         padded_region &= target.geometry;
 
         // Actual region which will be repainted by this render instance.
-        wf::region_t we_repaint = padded_region;
+        wf::region_t we_repaint = padded_region | (damage & bbox & target.geometry);
 
         this->saved_pixels   = self->acquire_saved_pixel_buffer();
         saved_pixels->region =
@@ -213,8 +358,32 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
         if (!damage.empty())
         {
             auto translucent_damage = calculate_translucent_damage(target, damage);
-            self->provider()->prepare_blur(target, translucent_damage);
-            self->provider()->render(tex, bounding_box, damage, target, target);
+            if (cache_used)
+            {
+                if (!cache_missing.empty())
+                {
+                    // Only the surroundings of the missing parts need to be blurred.
+                    auto blur_region = cache_missing;
+                    blur_region.expand_edges(
+                        calculate_damage_padding(target, self->provider()->calculate_blur_radius()));
+                    self->provider()->prepare_blur(target, blur_region & translucent_damage);
+                    self->provider()->store_prepared_blur(cache, cache_box,
+                        target.framebuffer_region_from_geometry_region(cache_missing));
+                    cache_valid |= cache_missing;
+                    cache_missing.clear();
+                }
+
+                self->provider()->render(tex, bounding_box, damage, target, target, cache, cache_box);
+            } else
+            {
+                self->provider()->prepare_blur(target, translucent_damage);
+                self->provider()->render(tex, bounding_box, damage, target, target);
+            }
+        }
+
+        if (!saved_pixels)
+        {
+            return;
         }
 
         OpenGL::render_begin(target);
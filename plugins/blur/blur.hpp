@@ -152,6 +152,32 @@ class wf_blur_base
      */
     void render(wf::texture_t src_tex, wlr_box src_box, const wf::region_t& damage,
         const wf::render_target_t& background_source_fb, const wf::render_target_t& target_fb);
+
+    /**
+     * Same as render(), but blend the view with a blurred background stored in @background (for example a
+     * cache filled with store_prepared_blur()) instead of the one prepared by the last @prepare_blur.
+     *
+     * @param background_box The framebuffer box covered by @background.
+     */
+    void render(wf::texture_t src_tex, wlr_box src_box, const wf::region_t& damage,
+        const wf::render_target_t& background_source_fb, const wf::render_target_t& target_fb,
+        const wf::framebuffer_t& background, wlr_box background_box);
+
+    /**
+     * Calculate the framebuffer box which a blurred background of @geometry covers. The boxes of the blurred
+     * backgrounds prepared by @prepare_blur are aligned to it, so that parts of them can be copied to a
+     * cache of the blurred background of @geometry.
+     */
+    wlr_box calculate_blur_box(const wf::render_target_t& target_fb, wlr_box geometry);
+
+    /**
+     * Copy the parts of the blurred background prepared by the last @prepare_blur which are in @fb_region
+     * to @cache, which covers the framebuffer box @cache_box. The cache is (re)allocated if its size does
+     * not match, in which case its previous contents are lost.
+     *
+     * @param fb_region The region to copy, in framebuffer coordinates.
+     */
+    void store_prepared_blur(wf::framebuffer_t& cache, wlr_box cache_box, const wf::region_t& fb_region);
 };
 
 std::unique_ptr<wf_blur_base> create_box_blur();
@@ -1,8 +1,13 @@
 #include "ipc.hpp"
 #include "wayfire/plugins/common/shared-core-data.hpp"
+#include <algorithm>
 #include <climits>
+#include <map>
+#include <unordered_set>
+#include <cstring>
 #include <wayfire/util/log.hpp>
 #include <wayfire/core.hpp>
+#include <wayfire/txn/transaction-manager.hpp>
 #include <wayfire/plugin.hpp>
 
 #include <fcntl.h>
@@ -26,6 +31,107 @@ wf::ipc::server_t::server_t()
     {
         do_accept_new_client();
     };
+
+    idle_disconnect.set_callback([=] ()
+    {
+        while (!clients_to_disconnect.empty())
+        {
+            client_disappeared(clients_to_disconnect.back());
+        }
+    });
+
+    get_queue_stats = [=] (nlohmann::json)
+    {
+        auto response = wf::ipc::json_ok();
+        response["clients"] = nlohmann::json::array();
+        for (auto& client : clients)
+        {
+            auto& stats = client->get_queue_stats();
+            nlohmann::json entry;
+            entry["pid"]              = client->get_pid();
+            entry["queued-messages"]  = stats.queued_messages;
+            entry["queued-bytes"]     = stats.queued_bytes;
+            entry["max-queued-bytes"] = stats.max_queued_bytes;
+            entry["dropped-events"]   = stats.dropped_events;
+            entry["coalesced-events"] = stats.coalesced_events;
+            response["clients"].push_back(entry);
+        }
+
+        return response;
+    };
+
+    set_encoding = [=] (nlohmann::json data, client_interface_t *client)
+    {
+        WFJSON_EXPECT_FIELD(data, "encoding", string);
+        static const std::map<std::string, encoding_t> encodings = {
+            {"json", encoding_t::JSON},
+            {"cbor", encoding_t::CBOR},
+            {"msgpack", encoding_t::MSGPACK},
+        };
+
+        auto it = encodings.find(data["encoding"]);
+        if (it == encodings.end())
+        {
+            return wf::ipc::json_error("Unsupported encoding " + data["encoding"].get<std::string>());
+        }
+
+        auto ipc_client = dynamic_cast<client_t*>(client);
+        if (!ipc_client)
+        {
+            return wf::ipc::json_error("The encoding can only be changed for socket clients");
+        }
+
+        ipc_client->request_encoding(it->second);
+        return wf::ipc::json_ok();
+    };
+
+    batch = [=] (nlohmann::json data, client_interface_t *client)
+    {
+        WFJSON_EXPECT_FIELD(data, "calls", array);
+        WFJSON_OPTIONAL_FIELD(data, "atomic", boolean);
+        WFJSON_OPTIONAL_FIELD(data, "stop-on-error", boolean);
+        for (auto& call : data["calls"])
+        {
+            if (!call.is_object() || !call.contains("method") || !call["method"].is_string())
+            {
+                return wf::ipc::json_error("Each call must be an object with a method name");
+            }
+        }
+
+        // In an atomic batch, all transactions scheduled by the calls (for example, geometry changes of
+        // views) are merged, so that clients never see a partially applied batch.
+        const bool atomic        = data.value("atomic", false);
+        const bool stop_on_error = data.value("stop-on-error", false);
+        if (atomic)
+        {
+            wf::get_core().tx_manager->begin_batch();
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["results"] = nlohmann::json::array();
+        for (auto& call : data["calls"])
+        {
+            auto result = method_repository->call_method(call["method"],
+                call.value("data", nlohmann::json::object()), client);
+            const bool failed = result.is_object() && result.contains("error");
+            response["results"].push_back(std::move(result));
+            if (failed && stop_on_error)
+            {
+                break;
+            }
+        }
+
+        if (atomic)
+        {
+            wf::get_core().tx_manager->end_batch();
+        }
+
+        return response;
+    };
+
+    method_repository->register_method("ipc/queue-stats", get_queue_stats);
+    method_repository->register_method("ipc/set-encoding", set_encoding);
+    method_repository->register_method("ipc/batch", batch);
 }
 
 void wf::ipc::server_t::init(std::string socket_path)
@@ -44,6 +150,9 @@ void wf::ipc::server_t::init(std::string socket_path)
 
 wf::ipc::server_t::~server_t()
 {
+    method_repository->unregister_method("ipc/queue-stats");
+    method_repository->unregister_method("ipc/set-encoding");
+    method_repository->unregister_method("ipc/batch");
     if (fd != -1)
     {
         close(fd);
@@ -120,6 +229,9 @@ void wf::ipc::server_t::do_accept_new_client()
 void wf::ipc::server_t::client_disappeared(client_t *client)
 {
     LOGD("Removing IPC client ", client);
+    clients_to_disconnect.erase(
+        std::remove(clients_to_disconnect.begin(), clients_to_disconnect.end(), client),
+        clients_to_disconnect.end());
 
     client_disconnected_signal ev;
     ev.client = client;
@@ -130,10 +242,36 @@ void wf::ipc::server_t::client_disappeared(client_t *client)
     clients.erase(it, clients.end());
 }
 
+void wf::ipc::server_t::schedule_disconnect(client_t *client)
+{
+    if (std::find(clients_to_disconnect.begin(), clients_to_disconnect.end(), client) ==
+        clients_to_disconnect.end())
+    {
+        clients_to_disconnect.push_back(client);
+    }
+
+    idle_disconnect.run_once();
+}
+
+wf::ipc::backpressure_policy_t wf::ipc::server_t::get_backpressure_policy()
+{
+    const std::string policy = backpressure_policy_opt;
+    if (policy == "coalesce")
+    {
+        return backpressure_policy_t::COALESCE;
+    } else if (policy == "disconnect")
+    {
+        return backpressure_policy_t::DISCONNECT;
+    }
+
+    return backpressure_policy_t::DROP_OLDEST;
+}
+
 void wf::ipc::server_t::handle_incoming_message(
     client_t *client, nlohmann::json message)
 {
     client->send_json(method_repository->call_method(message["method"], message["data"], client));
+    client->apply_requested_encoding();
 }
 
 /* --------------------------- Per-client code ------------------------------*/
@@ -154,6 +292,13 @@ wf::ipc::client_t::client_t(server_t *ipc, int fd)
     this->fd  = fd;
     this->ipc = ipc;
 
+    ucred cred;
+    socklen_t cred_len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0)
+    {
+        this->pid = cred.pid;
+    }
+
     auto ev_loop = wf::get_core().ev_loop;
     source = wl_event_loop_add_fd(ev_loop, fd, WL_EVENT_READABLE,
         wl_loop_handle_ipc_client_fd_event, &this->handle_fd_activity);
@@ -162,7 +307,26 @@ wf::ipc::client_t::client_t(server_t *ipc, int fd)
     buffer.resize(MAX_MESSAGE_LEN + 1);
     this->handle_fd_activity = [=] (uint32_t event_mask)
     {
-        handle_fd_incoming(event_mask);
+        if (event_mask & (WL_EVENT_ERROR | WL_EVENT_HANGUP))
+        {
+            ipc->client_disappeared(this);
+            // this no longer exists
+            return;
+        }
+
+        if (event_mask & WL_EVENT_WRITABLE)
+        {
+            if (!flush_output_queue())
+            {
+                ipc->client_disappeared(this);
+                return;
+            }
+        }
+
+        if (event_mask & WL_EVENT_READABLE)
+        {
+            handle_fd_incoming(event_mask);
+        }
     };
 }
 
@@ -195,6 +359,45 @@ int wf::ipc::client_t::read_up_to(int n, int *available)
     return 0;
 }
 
+static nlohmann::json decode_message(const char *data, uint32_t len, wf::ipc::encoding_t encoding)
+{
+    switch (encoding)
+    {
+      case wf::ipc::encoding_t::CBOR:
+        return nlohmann::json::from_cbor(data, data + len, true, false);
+
+      case wf::ipc::encoding_t::MSGPACK:
+        return nlohmann::json::from_msgpack(data, data + len, true, false);
+
+      case wf::ipc::encoding_t::JSON:
+        break;
+    }
+
+    return nlohmann::json::parse(data, data + len, nullptr, false);
+}
+
+/**
+ * Encode the message and append it to @out.
+ */
+static void encode_message(const nlohmann::json& json, wf::ipc::encoding_t encoding, std::string& out)
+{
+    switch (encoding)
+    {
+      case wf::ipc::encoding_t::CBOR:
+        nlohmann::json::to_cbor(json, nlohmann::detail::output_adapter<char>(out));
+        return;
+
+      case wf::ipc::encoding_t::MSGPACK:
+        nlohmann::json::to_msgpack(json, nlohmann::detail::output_adapter<char>(out));
+        return;
+
+      case wf::ipc::encoding_t::JSON:
+        break;
+    }
+
+    out += json.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+}
+
 void wf::ipc::client_t::handle_fd_incoming(uint32_t event_mask)
 {
     if (event_mask & (WL_EVENT_ERROR | WL_EVENT_HANGUP))
@@ -250,10 +453,17 @@ void wf::ipc::client_t::handle_fd_incoming(uint32_t event_mask)
         // Finally, received the message, make sure we have a terminating NULL byte
         buffer[current_buffer_valid] = '\0';
         char *str    = buffer.data() + HEADER_LEN;
-        auto message = nlohmann::json::parse(str, nullptr, false);
+        auto message = decode_message(str, len, encoding);
         if (message.is_discarded())
         {
-            LOGE("Client's message could not be parsed: ", str);
+            if (encoding == encoding_t::JSON)
+            {
+                LOGE("Client's message could not be parsed: ", str);
+            } else
+            {
+                LOGE("Client's message could not be decoded (", len, " bytes)");
+            }
+
             ipc->client_disappeared(this);
             return;
         }
@@ -278,29 +488,212 @@ wf::ipc::client_t::~client_t()
     close(this->fd);
 }
 
-static bool write_exact(int fd, char *buf, int n)
+/**
+ * Events for the same object can replace each other if the client cannot keep up, for example, only the
+ * last geometry change of a view is interesting.
+ */
+static std::string get_event_key(const nlohmann::json& json)
+{
+    if (!json.is_object() || !json.contains("event") || !json["event"].is_string())
+    {
+        return "";
+    }
+
+    std::string key = json["event"];
+    for (const char *object : {"view", "output", "wset"})
+    {
+        if (json.contains(object) && json[object].is_object() && json[object].contains("id"))
+        {
+            key += std::string("/") + object + "/" + json[object]["id"].dump();
+        }
+    }
+
+    return key;
+}
+
+void wf::ipc::client_t::send_json(nlohmann::json json)
+{
+    if (disconnecting)
+    {
+        return;
+    }
+
+    queued_message_t message;
+    message.event_key = get_event_key(json);
+
+    // Reserve space for the header, it is filled in once the length of the payload is known.
+    message.data.assign(HEADER_LEN, '\0');
+    encode_message(json, encoding, message.data);
+    uint32_t len = message.data.size() - HEADER_LEN;
+    std::memcpy(message.data.data(), &len, HEADER_LEN);
+
+    stats.queued_bytes += message.data.size();
+    stats.max_queued_bytes = std::max(stats.max_queued_bytes, stats.queued_bytes);
+    output_queue.push_back(std::move(message));
+    stats.queued_messages = output_queue.size();
+
+    if (!flush_output_queue())
+    {
+        disconnecting = true;
+        ipc->schedule_disconnect(this);
+        return;
+    }
+
+    enforce_queue_limit();
+}
+
+void wf::ipc::client_t::request_encoding(encoding_t encoding)
 {
-    while (n > 0)
+    this->requested_encoding = encoding;
+}
+
+void wf::ipc::client_t::apply_requested_encoding()
+{
+    if (requested_encoding)
     {
-        int w = write(fd, buf, n);
-        if (w <= 0)
+        LOGD("IPC client ", pid, " switched to encoding ", (int)*requested_encoding);
+        this->encoding = *requested_encoding;
+        requested_encoding.reset();
+    }
+}
+
+const wf::ipc::client_t::queue_stats_t& wf::ipc::client_t::get_queue_stats() const
+{
+    return stats;
+}
+
+pid_t wf::ipc::client_t::get_pid() const
+{
+    return pid;
+}
+
+bool wf::ipc::client_t::flush_output_queue()
+{
+    while (!output_queue.empty())
+    {
+        auto& data = output_queue.front().data;
+        ssize_t w  = write(fd, data.data() + front_written, data.size() - front_written);
+        if (w < 0)
         {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+
+            LOGW("Failed to write to IPC client ", pid, ": ", strerror(errno));
             return false;
         }
 
-        n -= w;
+        front_written += w;
+        stats.queued_bytes -= w;
+        if (front_written == data.size())
+        {
+            output_queue.pop_front();
+            front_written = 0;
+        }
     }
 
+    stats.queued_messages = output_queue.size();
+    update_event_mask();
     return true;
 }
 
-void wf::ipc::client_t::send_json(nlohmann::json json)
+void wf::ipc::client_t::coalesce_events(size_t limit)
 {
-    std::string buffer = json.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
-    uint32_t len = buffer.length();
+    // Going from the newest message to the oldest, mark events for which a newer event with the same key is
+    // queued, until enough space is freed. The first message may have been written partially already, in
+    // which case it must be completed.
+    const size_t first = (front_written > 0) ? 1 : 0;
+    std::unordered_set<std::string> newer_keys;
+    std::vector<bool> coalesced(output_queue.size(), false);
+    size_t freed = 0;
+    for (size_t i = output_queue.size(); (i > first) && (stats.queued_bytes - freed > limit); i--)
+    {
+        auto& message = output_queue[i - 1];
+        if (!message.event_key.empty() && !newer_keys.insert(message.event_key).second)
+        {
+            coalesced[i - 1] = true;
+            freed += message.data.size();
+            ++stats.coalesced_events;
+        }
+    }
 
-    write_exact(fd, (char*)&len, 4);
-    write_exact(fd, buffer.data(), len);
+    if (freed == 0)
+    {
+        return;
+    }
+
+    std::deque<queued_message_t> kept;
+    for (size_t i = 0; i < output_queue.size(); i++)
+    {
+        if (!coalesced[i])
+        {
+            kept.push_back(std::move(output_queue[i]));
+        }
+    }
+
+    output_queue = std::move(kept);
+    stats.queued_bytes   -= freed;
+    stats.queued_messages = output_queue.size();
+}
+
+void wf::ipc::client_t::enforce_queue_limit()
+{
+    const size_t limit = std::max(0, (int)ipc->max_queued_bytes);
+    // A single message is always allowed to complete, even if it is larger than the limit.
+    if ((stats.queued_bytes <= limit) || (output_queue.size() <= 1))
+    {
+        return;
+    }
+
+    const auto policy = ipc->get_backpressure_policy();
+    if (policy == backpressure_policy_t::COALESCE)
+    {
+        coalesce_events(limit);
+    }
+
+    if ((policy != backpressure_policy_t::DISCONNECT) && (stats.queued_bytes > limit))
+    {
+        // Method responses are never dropped, since clients wait for them.
+        auto it = output_queue.begin() + (front_written > 0 ? 1 : 0);
+        while ((it != output_queue.end()) && (stats.queued_bytes > limit))
+        {
+            if (it->event_key.empty())
+            {
+                ++it;
+                continue;
+            }
+
+            stats.queued_bytes -= it->data.size();
+            it = output_queue.erase(it);
+            ++stats.dropped_events;
+        }
+
+        stats.queued_messages = output_queue.size();
+    }
+
+    if (stats.queued_bytes > limit)
+    {
+        LOGW("IPC client ", pid, " is not reading its messages (", stats.queued_bytes,
+            " bytes queued), disconnecting.");
+        disconnecting = true;
+        ipc->schedule_disconnect(this);
+    }
+}
+
+void wf::ipc::client_t::update_event_mask()
+{
+    const bool need_writable = !output_queue.empty();
+    if (need_writable != waiting_writable)
+    {
+        waiting_writable = need_writable;
+        wl_event_source_fd_update(source, WL_EVENT_READABLE | (need_writable ? WL_EVENT_WRITABLE : 0));
+    }
 }
 
 namespace wf
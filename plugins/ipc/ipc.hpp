@@ -1,8 +1,12 @@
 #pragma once
 
+#include <deque>
+#include <optional>
 #include <nlohmann/json.hpp>
 #include <sys/un.h>
 #include <wayfire/object.hpp>
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/util.hpp>
 #include <wayland-server.h>
 #include <wayfire/plugins/common/shared-core-data.hpp>
 #include "ipc-method-repository.hpp"
@@ -11,6 +15,17 @@ namespace wf
 {
 namespace ipc
 {
+/**
+ * The wire encoding of the messages exchanged with a client. Messages are always prefixed by their length,
+ * only the payload is encoded differently.
+ */
+enum class encoding_t
+{
+    JSON,
+    CBOR,
+    MSGPACK,
+};
+
 /**
  * Represents a single connected client to the IPC socket.
  */
@@ -20,12 +35,77 @@ class client_t : public client_interface_t
   public:
     client_t(server_t *server, int client_fd);
     ~client_t();
+
+    /**
+     * Queue a message for the client. The message is written immediately if possible, otherwise, it is
+     * written as soon as the socket becomes writable again, so that a slow client never blocks the
+     * compositor.
+     */
     void send_json(nlohmann::json json) override;
 
+    /** Statistics about the output queue of a client. */
+    struct queue_stats_t
+    {
+        /** The number of messages which have not been fully written yet. */
+        size_t queued_messages = 0;
+        /** The number of bytes which have not been written yet. */
+        size_t queued_bytes = 0;
+        /** The largest number of bytes which were queued at any time. */
+        size_t max_queued_bytes = 0;
+        /** The number of events which were dropped because the queue was full. */
+        uint64_t dropped_events = 0;
+        /** The number of events which were replaced by a newer event of the same kind. */
+        uint64_t coalesced_events = 0;
+    };
+
+    const queue_stats_t& get_queue_stats() const;
+    /** @return The pid of the client process, or -1 if unknown. */
+    pid_t get_pid() const;
+
+    /**
+     * Switch the encoding of the messages exchanged with the client, after the reply to the current request
+     * has been sent in the old encoding.
+     */
+    void request_encoding(encoding_t encoding);
+    /** Apply the encoding requested with request_encoding(), if any. */
+    void apply_requested_encoding();
+
   private:
     int fd;
     wl_event_source *source;
     server_t *ipc;
+    pid_t pid = -1;
+    encoding_t encoding = encoding_t::JSON;
+    std::optional<encoding_t> requested_encoding;
+
+    struct queued_message_t
+    {
+        /** The message, including its header. */
+        std::string data;
+        /** Events with the same key are considered equivalent, empty for method responses. */
+        std::string event_key;
+    };
+
+    /** Messages waiting to be written, oldest first. */
+    std::deque<queued_message_t> output_queue;
+    /** The number of bytes of the first message in the queue which were already written. */
+    size_t front_written = 0;
+    queue_stats_t stats;
+    /** Whether WL_EVENT_WRITABLE is enabled on the event source. */
+    bool waiting_writable = false;
+    /** Whether the client is about to be disconnected, in which case nothing more is sent. */
+    bool disconnecting = false;
+
+    /**
+     * Write as much of the output queue as possible without blocking.
+     * @return false on a write error.
+     */
+    bool flush_output_queue();
+    /** Apply the backpressure policy if the output queue has grown too large. */
+    void enforce_queue_limit();
+    /** Drop queued events which are superseded by newer events with the same key, until within @limit. */
+    void coalesce_events(size_t limit);
+    void update_event_mask();
 
     int current_buffer_valid = 0;
     std::vector<char> buffer;
@@ -36,6 +116,19 @@ class client_t : public client_interface_t
     void handle_fd_incoming(uint32_t);
 };
 
+/**
+ * What to do when the output queue of a client exceeds its limit.
+ */
+enum class backpressure_policy_t
+{
+    /** Drop the oldest queued events. */
+    DROP_OLDEST,
+    /** Replace queued events with newer events for the same object, then drop the oldest events. */
+    COALESCE,
+    /** Disconnect the client. */
+    DISCONNECT,
+};
+
 /**
  * The IPC server is a singleton object accessed via shared_data::ref_ptr_t.
  * It represents the IPC socket used for communication with clients.
@@ -55,6 +148,25 @@ class server_t
 
     void client_disappeared(client_t *client);
 
+    /**
+     * Disconnect the client once the event loop is idle. This is used when the client misbehaves in the
+     * middle of sending a message, when other code might still be holding a pointer to it.
+     */
+    void schedule_disconnect(client_t *client);
+    std::vector<client_t*> clients_to_disconnect;
+    wf::wl_idle_call idle_disconnect;
+
+    wf::option_wrapper_t<int> max_queued_bytes{"ipc/max_queued_bytes"};
+    wf::option_wrapper_t<std::string> backpressure_policy_opt{"ipc/backpressure_policy"};
+    backpressure_policy_t get_backpressure_policy();
+
+    /** Report the state of the output queues of all clients. */
+    wf::ipc::method_callback get_queue_stats;
+    /** Negotiate the encoding of the messages with a client. */
+    wf::ipc::method_callback_full set_encoding;
+    /** Execute multiple method calls in a single request. */
+    wf::ipc::method_callback_full batch;
+
     int fd = -1;
 
     /**
@@ -2,6 +2,7 @@
 #include <wayfire/per-output-plugin.hpp>
 #include <wayfire/view.hpp>
 #include <wayfire/output.hpp>
+#include <wayfire/render-manager.hpp>
 #include <wayfire/toplevel-view.hpp>
 #include <wayfire/seat.hpp>
 #include <wayfire/input-device.hpp>
@@ -15,6 +16,8 @@
 #include "wayfire/plugins/common/shared-core-data.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include "wayfire/signal-provider.hpp"
+#include "wayfire/signal-profiler.hpp"
+#include "wayfire/txn/transaction-stats.hpp"
 #include "wayfire/view-helpers.hpp"
 #include "wayfire/window-manager.hpp"
 #include "wayfire/workarea.hpp"
@@ -109,6 +112,45 @@ static std::string wlr_input_device_type_to_string(wlr_input_device_type type)
     }
 }
 
+static std::string frame_stage_to_string(wf::frame_profile_stage_t stage)
+{
+    switch (stage)
+    {
+      case wf::FRAME_STAGE_EFFECTS_PRE:
+        return "effects-pre";
+
+      case wf::FRAME_STAGE_EFFECTS_DAMAGE:
+        return "effects-damage";
+
+      case wf::FRAME_STAGE_DIRECT_SCANOUT:
+        return "direct-scanout";
+
+      case wf::FRAME_STAGE_START_FRAME:
+        return "start-frame";
+
+      case wf::FRAME_STAGE_GATHER:
+        return "gather-instructions";
+
+      case wf::FRAME_STAGE_RENDER:
+        return "render-instructions";
+
+      case wf::FRAME_STAGE_EFFECTS_OVERLAY:
+        return "effects-overlay";
+
+      case wf::FRAME_STAGE_POST_EFFECTS:
+        return "post-effects";
+
+      case wf::FRAME_STAGE_SW_CURSORS:
+        return "software-cursors";
+
+      case wf::FRAME_STAGE_SWAP_BUFFERS:
+        return "swap-buffers";
+
+      default:
+        return "unknown";
+    }
+}
+
 static wf::geometry_t get_view_base_geometry(wayfire_view view)
 {
     auto sroot = view->get_surface_root_node();
@@ -133,6 +175,9 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
     void init() override
     {
         method_repository->register_method("wayfire/configuration", get_wayfire_configuration_info);
+        method_repository->register_method("wayfire/frame-timings", get_frame_timings);
+        method_repository->register_method("wayfire/signal-profile", get_signal_profile);
+        method_repository->register_method("wayfire/transaction-stats", get_transaction_stats);
         method_repository->register_method("input/list-devices", list_input_devices);
         method_repository->register_method("input/configure-device", configure_input_device);
         method_repository->register_method("window-rules/events/watch", on_client_watch);
@@ -154,6 +199,9 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
     void fini() override
     {
         method_repository->unregister_method("wayfire/configuration");
+        method_repository->unregister_method("wayfire/frame-timings");
+        method_repository->unregister_method("wayfire/signal-profile");
+        method_repository->unregister_method("wayfire/transaction-stats");
         method_repository->unregister_method("input/list-devices");
         method_repository->unregister_method("input/configure-device");
         method_repository->unregister_method("window-rules/events/watch");
@@ -169,10 +217,15 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
         method_repository->unregister_method("window-rules/get-focused-output");
         method_repository->unregister_method("window-rules/close-view");
         fini_output_tracking();
+        for (auto& wo : wf::get_core().output_layout->get_outputs())
+        {
+            wo->render->rem_effect(&flush_on_frame);
+        }
     }
 
     void handle_new_output(wf::output_t *output) override
     {
+        output->render->add_effect(&flush_on_frame, wf::OUTPUT_EFFECT_PRE);
         for (auto& [_, event] : signal_map)
         {
             if (event.connected_count)
@@ -189,6 +242,7 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
 
     void handle_output_removed(wf::output_t *output) override
     {
+        output->render->rem_effect(&flush_on_frame);
         nlohmann::json data;
         data["event"]  = "output-removed";
         data["output"] = output_to_json(output);
@@ -286,6 +340,150 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
         return response;
     };
 
+    wf::ipc::method_callback get_frame_timings = [=] (nlohmann::json data)
+    {
+        WFJSON_OPTIONAL_FIELD(data, "output-id", number_integer);
+        WFJSON_OPTIONAL_FIELD(data, "count", number_unsigned);
+
+        std::vector<wf::output_t*> outputs = wf::get_core().output_layout->get_outputs();
+        if (data.contains("output-id"))
+        {
+            auto wo = wf::ipc::find_output_by_id(data["output-id"]);
+            if (!wo)
+            {
+                return wf::ipc::json_error("output not found");
+            }
+
+            outputs = {wo};
+        }
+
+        const size_t count = data.value("count", (size_t)-1);
+        auto response = wf::ipc::json_ok();
+        response["outputs"] = nlohmann::json::array();
+        for (auto& wo : outputs)
+        {
+            nlohmann::json output;
+            output["id"]     = wo->get_id();
+            output["name"]   = wo->to_string();
+            output["frames"] = nlohmann::json::array();
+            for (auto& frame : wo->render->get_frame_timings(count))
+            {
+                nlohmann::json f;
+                f["sequence"]       = frame.sequence;
+                f["start-ns"]       = frame.start_ns;
+                f["gpu-ns"]         = frame.gpu_ns;
+                f["direct-scanout"] = frame.direct_scanout;
+                for (int i = 0; i < wf::FRAME_STAGE_TOTAL; i++)
+                {
+                    f["stages"][frame_stage_to_string((wf::frame_profile_stage_t)i)] = frame.stage_ns[i];
+                }
+
+                output["frames"].push_back(f);
+            }
+
+            response["outputs"].push_back(output);
+        }
+
+        return response;
+    };
+
+    wf::ipc::method_callback get_signal_profile = [=] (nlohmann::json data)
+    {
+        WFJSON_OPTIONAL_FIELD(data, "count", number_unsigned);
+        WFJSON_OPTIONAL_FIELD(data, "reset", boolean);
+
+        const size_t count = data.value("count", (size_t)-1);
+        auto response = wf::ipc::json_ok();
+        response["signals"] = nlohmann::json::array();
+        for (auto& signal : wf::signal::get_signal_profile())
+        {
+            if (response["signals"].size() >= count)
+            {
+                break;
+            }
+
+            nlohmann::json s;
+            s["signal"]    = signal.signal;
+            s["emissions"] = signal.emissions;
+            s["total-ns"]  = signal.total_ns;
+            s["listeners"] = nlohmann::json::array();
+            for (auto& listener : signal.listeners)
+            {
+                nlohmann::json l;
+                l["owner"]    = listener.owner;
+                l["callback"] = listener.callback;
+                l["calls"]    = listener.calls;
+                l["total-ns"] = listener.total_ns;
+                l["max-ns"]   = listener.max_ns;
+                s["listeners"].push_back(l);
+            }
+
+            response["signals"].push_back(s);
+        }
+
+        if (data.value("reset", false))
+        {
+            wf::signal::reset_signal_profile();
+        }
+
+        return response;
+    };
+
+    static nlohmann::json histogram_to_json(const wf::txn::latency_histogram_t& histogram)
+    {
+        nlohmann::json h;
+        h["count"]    = histogram.count;
+        h["total-us"] = histogram.total_us;
+        h["max-us"]   = histogram.max_us;
+        h["buckets"]  = nlohmann::json::array();
+        for (int i = 0; i < wf::txn::latency_histogram_t::NR_BUCKETS; i++)
+        {
+            nlohmann::json bucket;
+            bucket["below-us"] = wf::txn::latency_histogram_t::get_bucket_limit_us(i);
+            bucket["count"]    = histogram.buckets[i];
+            h["buckets"].push_back(bucket);
+        }
+
+        return h;
+    }
+
+    wf::ipc::method_callback get_transaction_stats = [=] (nlohmann::json data)
+    {
+        WFJSON_OPTIONAL_FIELD(data, "reset", boolean);
+
+        auto stats    = wf::txn::get_transaction_stats();
+        auto response = wf::ipc::json_ok();
+        response["applied"]   = stats.applied;
+        response["timed-out"] = stats.timed_out;
+        response["schedule-to-commit"] = histogram_to_json(stats.schedule_to_commit);
+        response["commit-to-apply"]    = histogram_to_json(stats.commit_to_apply);
+        response["object-types"] = nlohmann::json::array();
+        for (auto& type : stats.object_types)
+        {
+            nlohmann::json t;
+            t["type"]     = type.type;
+            t["timeouts"] = type.timeouts;
+            t["ready-latency"] = histogram_to_json(type.ready_latency);
+            response["object-types"].push_back(t);
+        }
+
+        response["recent-timeouts"] = nlohmann::json::array();
+        for (auto& timeout : stats.recent_timeouts)
+        {
+            nlohmann::json t;
+            t["duration-us"]  = timeout.duration_us;
+            t["late-objects"] = timeout.late_objects;
+            response["recent-timeouts"].push_back(t);
+        }
+
+        if (data.value("reset", false))
+        {
+            wf::txn::reset_transaction_stats();
+        }
+
+        return response;
+    };
+
     wf::ipc::method_callback list_views = [=] (nlohmann::json)
     {
         auto response = nlohmann::json::array();
@@ -516,55 +714,169 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
   private:
     wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> method_repository;
 
-    // Track a list of clients which have requested watch
-    std::map<wf::ipc::client_interface_t*, std::set<std::string>> clients;
+    /**
+     * The state of a client which has requested watch.
+     */
+    struct event_subscription_t
+    {
+        wf::ipc::client_interface_t *client;
+        /** The events the client is subscribed to. */
+        std::set<std::string> events;
+
+        /**
+         * Only events about these views are sent, if not empty.
+         * Events which are not about a view always pass.
+         */
+        std::set<uint32_t> view_ids;
+        std::set<std::string> app_ids;
+
+        /**
+         * Events which are coalesced: if several such events for the same view (or output) are emitted before
+         * the next flush, only the latest one is sent.
+         */
+        std::set<std::string> coalesced_events;
+        /** Interval between flushes of coalesced events in milliseconds, 0 means on the next frame. */
+        int flush_interval = 0;
+
+        /** Coalesced events which have not been sent yet, in the order they were last emitted. */
+        std::vector<nlohmann::json> pending;
+        /** The index in @pending of the event for each coalescing key. */
+        std::map<std::string, size_t> pending_index;
+        wf::wl_timer<false> flush_timer;
+    };
+
+    std::map<wf::ipc::client_interface_t*, std::unique_ptr<event_subscription_t>> clients;
+
+    /**
+     * If no frame is drawn (for example, because the events concern views which are not visible), coalesced
+     * events which wait for the next frame are flushed after this timeout.
+     */
+    static constexpr int FRAME_FLUSH_FALLBACK_MS = 100;
 
     wf::ipc::method_callback_full on_client_watch =
         [=] (nlohmann::json data, wf::ipc::client_interface_t *client)
     {
         static constexpr const char *EVENTS = "events";
         WFJSON_OPTIONAL_FIELD(data, EVENTS, array);
-        std::set<std::string> subscribed_to;
+        WFJSON_OPTIONAL_FIELD(data, "view-ids", array);
+        WFJSON_OPTIONAL_FIELD(data, "app-ids", array);
+        WFJSON_OPTIONAL_FIELD(data, "interval", number_unsigned);
+
+        auto sub = std::make_unique<event_subscription_t>();
+        sub->client = client;
         if (data.contains(EVENTS))
         {
-            for (auto& sub : data[EVENTS])
+            for (auto& ev : data[EVENTS])
             {
-                if (!sub.is_string())
+                if (!ev.is_string())
                 {
                     return wf::ipc::json_error("Event list contains non-string entries!");
                 }
 
-                if (signal_map.count(sub))
+                if (signal_map.count(ev))
                 {
-                    subscribed_to.insert((std::string)sub);
+                    sub->events.insert((std::string)ev);
                 }
             }
-        } else
+        }
+
+        // Like a missing list, an empty list (or one without known events) means all events.
+        if (sub->events.empty())
         {
             for (auto& [ev_name, _] : signal_map)
             {
-                subscribed_to.insert(ev_name);
+                sub->events.insert(ev_name);
             }
         }
 
-        for (auto& ev_name : subscribed_to)
+        if (data.contains("view-ids"))
+        {
+            for (auto& id : data["view-ids"])
+            {
+                if (!id.is_number_unsigned())
+                {
+                    return wf::ipc::json_error("View id list contains non-integer entries!");
+                }
+
+                sub->view_ids.insert((uint32_t)id);
+            }
+        }
+
+        if (data.contains("app-ids"))
+        {
+            for (auto& app_id : data["app-ids"])
+            {
+                if (!app_id.is_string())
+                {
+                    return wf::ipc::json_error("App id list contains non-string entries!");
+                }
+
+                sub->app_ids.insert((std::string)app_id);
+            }
+        }
+
+        // "coalesce" is either a list of events or true for all subscribed events.
+        if (data.contains("coalesce"))
+        {
+            if (data["coalesce"].is_boolean())
+            {
+                if (data["coalesce"])
+                {
+                    sub->coalesced_events = sub->events;
+                }
+            } else if (data["coalesce"].is_array())
+            {
+                for (auto& ev : data["coalesce"])
+                {
+                    if (!ev.is_string())
+                    {
+                        return wf::ipc::json_error("Coalesce list contains non-string entries!");
+                    }
+
+                    if (sub->events.count(ev))
+                    {
+                        sub->coalesced_events.insert((std::string)ev);
+                    }
+                }
+            } else
+            {
+                return wf::ipc::json_error("Field \"coalesce\" must be a boolean or an array");
+            }
+        }
+
+        sub->flush_interval = data.value("interval", 0);
+
+        // A client may change its subscription by calling watch again.
+        remove_subscription(client);
+        for (auto& ev_name : sub->events)
         {
             signal_map[ev_name].increase_count();
         }
 
-        clients[client] = subscribed_to;
+        clients[client] = std::move(sub);
         return wf::ipc::json_ok();
     };
 
-    wf::signal::connection_t<wf::ipc::client_disconnected_signal> on_client_disconnected =
-        [=] (wf::ipc::client_disconnected_signal *ev)
+    void remove_subscription(wf::ipc::client_interface_t *client)
     {
-        for (auto& ev_name : clients[ev->client])
+        auto it = clients.find(client);
+        if (it == clients.end())
+        {
+            return;
+        }
+
+        for (auto& ev_name : it->second->events)
         {
             signal_map[ev_name].decrease_count();
         }
 
-        clients.erase(ev->client);
+        clients.erase(it);
+    }
+
+    wf::signal::connection_t<wf::ipc::client_disconnected_signal> on_client_disconnected =
+        [=] (wf::ipc::client_disconnected_signal *ev)
+    {
+        remove_subscription(ev->client);
     };
 
     void send_view_to_subscribes(wayfire_view view, std::string event_name)
@@ -575,17 +887,136 @@ class ipc_rules_t : public wf::plugin_interface_t, public wf::per_output_tracker
         send_event_to_subscribes(event, event_name);
     }
 
+    static bool event_passes_filter(const event_subscription_t& sub, const nlohmann::json& data)
+    {
+        if (sub.view_ids.empty() && sub.app_ids.empty())
+        {
+            return true;
+        }
+
+        auto it = data.find("view");
+        if ((it == data.end()) || !it->is_object())
+        {
+            return true;
+        }
+
+        return (!sub.view_ids.empty() && sub.view_ids.count((*it)["id"].get<uint32_t>())) ||
+               (!sub.app_ids.empty() && sub.app_ids.count((*it)["app-id"].get<std::string>()));
+    }
+
+    /** Events about the same view, or the same output if they are not about a view, replace each other. */
+    static std::string get_coalescing_key(const nlohmann::json& data, const std::string& event_name)
+    {
+        auto view = data.find("view");
+        if ((view != data.end()) && view->is_object())
+        {
+            return event_name + "/view/" + (*view)["id"].dump();
+        }
+
+        auto output = data.find("output");
+        if ((output != data.end()) && !output->is_null())
+        {
+            return event_name + "/output/" + (output->is_object() ? (*output)["id"] : *output).dump();
+        }
+
+        return event_name;
+    }
+
     void send_event_to_subscribes(const nlohmann::json& data, const std::string& event_name)
     {
-        for (auto& [client, events] : clients)
+        for (auto& [client, sub] : clients)
         {
-            if (events.empty() || events.count(event_name))
+            if (!sub->events.count(event_name) || !event_passes_filter(*sub, data))
+            {
+                continue;
+            }
+
+            if (sub->coalesced_events.count(event_name))
+            {
+                queue_coalesced_event(*sub, data, event_name);
+            } else
             {
+                // Send pending events first, so that the client sees events in order.
+                flush_pending_events(*sub);
                 client->send_json(data);
             }
         }
     }
 
+    void queue_coalesced_event(event_subscription_t& sub, const nlohmann::json& data,
+        const std::string& event_name)
+    {
+        const auto key = get_coalescing_key(data, event_name);
+        auto it = sub.pending_index.find(key);
+        if (it == sub.pending_index.end())
+        {
+            sub.pending_index[key] = sub.pending.size();
+            sub.pending.push_back(data);
+        } else
+        {
+            // The latest state wins, but the previous state (old-geometry, old-wset, etc.) is the one from
+            // before the first coalesced event.
+            const size_t old_index = it->second;
+            nlohmann::json merged = data;
+            for (auto& [field, value] : sub.pending[old_index].items())
+            {
+                if (field.rfind("old-", 0) == 0)
+                {
+                    merged[field] = value;
+                }
+            }
+
+            // The event moves to the end, so that the client sees the events in the order of their latest
+            // emission. Otherwise, focusing A, B and then A again would be sent as A, B.
+            sub.pending.erase(sub.pending.begin() + old_index);
+            for (auto& [_, index] : sub.pending_index)
+            {
+                if (index > old_index)
+                {
+                    --index;
+                }
+            }
+
+            it->second = sub.pending.size();
+            sub.pending.push_back(std::move(merged));
+        }
+
+        if (sub.flush_timer.is_connected())
+        {
+            return;
+        }
+
+        const int timeout = sub.flush_interval > 0 ? sub.flush_interval : FRAME_FLUSH_FALLBACK_MS;
+        sub.flush_timer.set_timeout(timeout, [=, &sub] ()
+        {
+            flush_pending_events(sub);
+        });
+    }
+
+    void flush_pending_events(event_subscription_t& sub)
+    {
+        sub.flush_timer.disconnect();
+        auto pending = std::move(sub.pending);
+        sub.pending.clear();
+        sub.pending_index.clear();
+        for (auto& event : pending)
+        {
+            sub.client->send_json(std::move(event));
+        }
+    }
+
+    /** Flush coalesced events of the clients which asked for them on each frame. */
+    wf::effect_hook_t flush_on_frame = [=] ()
+    {
+        for (auto& [_, sub] : clients)
+        {
+            if ((sub->flush_interval == 0) && !sub->pending.empty())
+            {
+                flush_pending_events(*sub);
+            }
+        }
+    };
+
     wf::signal::connection_t<wf::view_mapped_signal> on_view_mapped = [=] (wf::view_mapped_signal *ev)
     {
         send_view_to_subscribes(ev->view, "view-mapped");
@@ -0,0 +1,192 @@
+#include "rule-index.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace wf
+{
+namespace
+{
+/** Attributes by which rules are indexed. */
+const std::vector<std::string> indexed_attributes = {"app_id", "type"};
+
+/**
+ * Split the text of a rule into words, operators and quoted strings (which keep their quotes).
+ *
+ * @return std::nullopt for texts which are not understood, e.g. with escape sequences or unterminated
+ *   strings.
+ */
+std::optional<std::vector<std::string>> tokenize(const std::string& text)
+{
+    static constexpr std::string_view operators = "&|!()";
+
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        const char c = text[i];
+        if (std::isspace((unsigned char)c))
+        {
+            ++i;
+        } else if (c == '"')
+        {
+            const size_t end = text.find('"', i + 1);
+            if (end == std::string::npos)
+            {
+                return {};
+            }
+
+            tokens.push_back(text.substr(i, end - i + 1));
+            if (tokens.back().find('\\') != std::string::npos)
+            {
+                return {};
+            }
+
+            i = end + 1;
+        } else if (operators.find(c) != std::string_view::npos)
+        {
+            tokens.push_back(std::string(1, c));
+            ++i;
+        } else
+        {
+            size_t end = i;
+            while ((end < text.size()) && !std::isspace((unsigned char)text[end]) &&
+                   (text[end] != '"') && (operators.find(text[end]) == std::string_view::npos))
+            {
+                ++end;
+            }
+
+            tokens.push_back(text.substr(i, end - i));
+            i = end;
+        }
+    }
+
+    return tokens;
+}
+
+struct rule_class_t
+{
+    std::optional<std::string> signal;
+    std::optional<std::pair<std::string, std::string>> key;
+};
+
+rule_class_t classify(const std::string& text)
+{
+    rule_class_t result;
+
+    auto tokens = tokenize(text);
+    if (!tokens || (tokens->size() < 2) || ((*tokens)[0] != "on"))
+    {
+        return result;
+    }
+
+    result.signal = (*tokens)[1];
+
+    // The condition is between `if` and `then`. Rules with an else branch apply to all views.
+    const auto begin = tokens->begin() + 2;
+    const auto then  = std::find(begin, tokens->end(), "then");
+    if ((begin == tokens->end()) || (*begin != "if") || (then == tokens->end()) ||
+        (std::find(then, tokens->end(), "else") != tokens->end()))
+    {
+        return result;
+    }
+
+    // Only conjunctions of simple terms `attribute operator value` are understood.
+    std::optional<std::pair<std::string, std::string>> key;
+    auto term = begin + 1;
+    while (true)
+    {
+        if (then - term < 3)
+        {
+            return result;
+        }
+
+        const auto& attribute = term[0];
+        const auto& op    = term[1];
+        const auto& value = term[2];
+        const bool is_indexed = std::find(indexed_attributes.begin(), indexed_attributes.end(),
+            attribute) != indexed_attributes.end();
+        if (!key && is_indexed && (op == "is") && (value.size() >= 2) && (value.front() == '"'))
+        {
+            key = {attribute, value.substr(1, value.size() - 2)};
+        }
+
+        term += 3;
+        if (term == then)
+        {
+            break;
+        }
+
+        if (*term != "&")
+        {
+            return result;
+        }
+
+        ++term;
+    }
+
+    result.key = key;
+    return result;
+}
+}
+
+void rule_index_t::clear()
+{
+    by_signal.clear();
+    any_signal = {};
+}
+
+void rule_index_t::add(size_t idx, const std::string& text)
+{
+    auto rule_class = classify(text);
+    auto& bucket    = rule_class.signal ? by_signal[*rule_class.signal] : any_signal;
+    if (rule_class.key)
+    {
+        bucket.keyed[rule_class.key->first][rule_class.key->second].push_back(idx);
+    } else
+    {
+        bucket.unkeyed.push_back(idx);
+    }
+}
+
+void rule_index_t::collect(const bucket_t& bucket, const attribute_getter_t& get_attribute,
+    std::vector<size_t>& candidates) const
+{
+    candidates.insert(candidates.end(), bucket.unkeyed.begin(), bucket.unkeyed.end());
+    for (const auto& [attribute, rules_by_value] : bucket.keyed)
+    {
+        auto value = get_attribute(attribute);
+        if (!value)
+        {
+            for (const auto& [_, rules] : rules_by_value)
+            {
+                candidates.insert(candidates.end(), rules.begin(), rules.end());
+            }
+
+            continue;
+        }
+
+        auto it = rules_by_value.find(*value);
+        if (it != rules_by_value.end())
+        {
+            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    }
+}
+
+void rule_index_t::get_candidates(const std::string& signal, const attribute_getter_t& get_attribute,
+    std::vector<size_t>& candidates) const
+{
+    candidates.clear();
+
+    auto it = by_signal.find(signal);
+    if (it != by_signal.end())
+    {
+        collect(it->second, get_attribute, candidates);
+    }
+
+    collect(any_signal, get_attribute, candidates);
+    std::sort(candidates.begin(), candidates.end());
+}
+}
@@ -0,0 +1,72 @@
+#ifndef RULE_INDEX_HPP
+#define RULE_INDEX_HPP
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wf
+{
+/**
+ * An index of the rules of the window-rules plugin, used to find the rules which can possibly apply to a
+ * view when a signal is triggered, without evaluating every rule.
+ *
+ * Rules are classified by their text:
+ * - Rules of the form `on <signal> ...` are only candidates for that signal.
+ * - Rules whose condition is a conjunction of simple terms, one of which is `app_id is "<value>"` or
+ *   `type is "<value>"`, are only candidates for views with that value of the attribute.
+ *
+ * Rules which cannot be classified (for example, because they have an else branch or a disjunction) are
+ * always candidates. Classification is only used to skip rules, the rules themselves still check the signal
+ * and the condition, so a rule being a candidate does not change whether it applies.
+ */
+class rule_index_t
+{
+  public:
+    /** A function which returns the value of a view attribute, or std::nullopt if it is not known. */
+    using attribute_getter_t = std::function<std::optional<std::string>(const std::string& attribute)>;
+
+    /** Remove all rules from the index. */
+    void clear();
+
+    /**
+     * Add a rule to the index.
+     *
+     * @param idx The index of the rule, in the order in which the rules should be evaluated.
+     * @param text The text of the rule.
+     */
+    void add(size_t idx, const std::string& text);
+
+    /**
+     * Get the candidate rules for a signal.
+     *
+     * @param signal The signal which was triggered.
+     * @param get_attribute Used to get the attributes of the view, only for attributes used by the rules.
+     * @param candidates Filled with the indices of the candidate rules, in increasing order.
+     */
+    void get_candidates(const std::string& signal, const attribute_getter_t& get_attribute,
+        std::vector<size_t>& candidates) const;
+
+  private:
+    struct bucket_t
+    {
+        /** Rules which apply to views with any attributes. */
+        std::vector<size_t> unkeyed;
+        /** Rules keyed by attribute name and the value it needs to have. */
+        std::map<std::string, std::unordered_map<std::string, std::vector<size_t>>> keyed;
+    };
+
+    /** Rules for a particular signal. */
+    std::unordered_map<std::string, bucket_t> by_signal;
+    /** Rules which could not be classified by signal. */
+    bucket_t any_signal;
+
+    void collect(const bucket_t& bucket, const attribute_getter_t& get_attribute,
+        std::vector<size_t>& candidates) const;
+};
+}
+
+#endif /* end of include guard: RULE_INDEX_HPP */
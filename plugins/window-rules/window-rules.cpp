@@ -16,6 +16,7 @@
 #include <wayfire/toplevel-view.hpp>
 
 #include "lambda-rules-registration.hpp"
+#include "rule-index.hpp"
 #include "view-action-interface.hpp"
 #include "wayfire/signal-provider.hpp"
 
@@ -62,9 +63,7 @@ class wayfire_window_rules_t : public wf::per_output_plugin_instance_t
     };
 
     std::vector<std::shared_ptr<wf::rule_t>> _rules;
-
-    wf::view_access_interface_t _access_interface;
-    wf::view_action_interface_t _action_interface;
+    wf::rule_index_t _rule_index;
 
     nonstd::observer_ptr<wf::lambda_rules_registrations_t> _lambda_registrations;
 };
@@ -111,11 +110,30 @@ void wayfire_window_rules_t::apply(const std::string & signal, wayfire_view view
         return;
     }
 
-    for (const auto & rule : _rules)
+    // Rule actions may trigger signals which apply the rules again, possibly for another view, so the
+    // interfaces and the candidates are local to this call. The access interface then reuses the view's
+    // properties for all rules.
+    wf::view_access_interface_t access_interface{view};
+    wf::view_action_interface_t action_interface;
+    action_interface.set_view(view);
+
+    // Evaluate only the rules for this signal which can match the view.
+    std::vector<size_t> candidates;
+    _rule_index.get_candidates(signal, [&] (const std::string& attribute) -> std::optional<std::string>
+    {
+        bool error = false;
+        auto value = access_interface.get(attribute, error);
+        if (error || !wf::is_string(value))
+        {
+            return {};
+        }
+
+        return wf::get_string(value);
+    }, candidates);
+
+    for (auto idx : candidates)
     {
-        _access_interface.set_view(view);
-        _action_interface.set_view(view);
-        auto error = rule->apply(signal, _access_interface, _action_interface);
+        auto error = _rules[idx]->apply(signal, access_interface, action_interface);
         if (error)
         {
             LOGE("Window-rules: Error while executing rule on ", signal, " signal.");
@@ -131,8 +149,7 @@ void wayfire_window_rules_t::apply(const std::string & signal, wayfire_view view
         bool error = false;
 
         // Assume we will use the view access interface.
-        _access_interface.set_view(view);
-        wf::access_interface_t & access_iface = _access_interface;
+        wf::access_interface_t & access_iface = access_interface;
 
         // If a custom access interface is set in the regoistration, use this one.
         if (registration->access_interface != nullptr)
@@ -161,7 +178,7 @@ void wayfire_window_rules_t::apply(const std::string & signal, wayfire_view view
         }
 
         // Run the lambda rule.
-        error = registration->rule_instance->apply(signal, _access_interface);
+        error = registration->rule_instance->apply(signal, access_interface);
 
         // Unload wrappers.
         registration->rule_instance->setIfLambda(nullptr);
@@ -180,6 +197,7 @@ void wayfire_window_rules_t::apply(const std::string & signal, wayfire_view view
 void wayfire_window_rules_t::setup_rules_from_config()
 {
     _rules.clear();
+    _rule_index.clear();
 
     wf::option_wrapper_t<wf::config::compound_list_t<std::string>> rule_list_option{"window-rules/rules"};
     auto rule_list = rule_list_option.value();
@@ -191,6 +209,7 @@ void wayfire_window_rules_t::setup_rules_from_config()
         auto rule = wf::rule_parser_t().parse(_lexer);
         if (rule != nullptr)
         {
+            _rule_index.add(_rules.size(), rule_str);
             _rules.push_back(rule);
         }
     }
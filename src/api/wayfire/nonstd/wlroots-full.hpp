@@ -94,6 +94,7 @@ extern "C"
 
 // Output management
 #include <wlr/types/wlr_output_layout.h>
+#include <wlr/types/wlr_output_layer.h>
 #include <wlr/types/wlr_output_management_v1.h>
 
 #if __has_include(<wlr-output-power-management-unstable-v1-protocol.h>)
@@ -48,6 +48,7 @@ extern "C"
     struct wlr_pointer_motion_event;
     struct wlr_output_layout;
     struct wlr_surface;
+    struct wlr_buffer;
     struct wlr_texture;
     struct wlr_viewporter;
 
@@ -290,6 +290,19 @@ void render_texture(wf::texture_t texture,
  */
 void draw_cached();
 
+/**
+ * Render the textured rectangle again, clipped to the rectangles of @region, with a single draw call.
+ *
+ * Instead of scissoring each rectangle and drawing the whole quad for each of them (as with draw_cached()),
+ * the quad is clipped to the rectangles on the CPU and all pieces are uploaded and drawn at once. @region is
+ * in the same coordinate system as the quad's geometry, so the result is the same as with scissoring only if
+ * the quad's transform does not rotate it and the region maps to whole pixels on the framebuffer. Note that
+ * the current scissor box still applies.
+ *
+ * See RENDER_FLAG_CACHED for detailed explanation.
+ */
+void draw_cached_clipped(const wf::region_t& region);
+
 /**
  * Clear the cached state.
  *
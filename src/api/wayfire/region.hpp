@@ -6,6 +6,25 @@
 /* ---------------------- pixman utility functions -------------------------- */
 namespace wf
 {
+/**
+ * Describes when a fragmented region should be replaced by its bounding box, see region_t::simplify().
+ *
+ * Drawing a slightly bigger area is usually much cheaper than iterating over many small rectangles in every
+ * stage which consumes the region (scissoring, damage expansion, transformations, etc.).
+ */
+struct region_simplify_policy_t
+{
+    /** Simplify regions with more rectangles than this. Zero or less disables the check. */
+    int max_rects = 0;
+
+    /**
+     * Simplify regions whose bounding box is at most this much bigger than the region itself, relative to the
+     * area of the region. For example, 0.25 allows the simplified region to cover 25% more pixels.
+     * Zero or less disables the check.
+     */
+    double max_area_overhead = 0.0;
+};
+
 struct region_t
 {
     region_t();
@@ -25,6 +44,16 @@ struct region_t
 
     void expand_edges(int amount);
     pixman_box32_t get_extents() const;
+    /* The number of rectangles the region consists of */
+    int size() const;
+    /* The number of pixels covered by the region */
+    int64_t area() const;
+
+    /**
+     * Replace the region by its bounding box if the policy says so.
+     * @return true if the region was simplified.
+     */
+    bool simplify(const region_simplify_policy_t& policy);
     bool contains_point(const point_t& point) const;
     bool contains_pointf(const pointf_t& point) const;
 
@@ -45,6 +45,55 @@ enum output_effect_type_t
 using post_hook_t = std::function<void (const wf::framebuffer_t& source,
     const wf::framebuffer_t& destination)>;
 
+/**
+ * The stages of an output repaint, as measured by the frame profiler.
+ */
+enum frame_profile_stage_t
+{
+    /* Running OUTPUT_EFFECT_PRE hooks */
+    FRAME_STAGE_EFFECTS_PRE     = 0,
+    /* Running OUTPUT_EFFECT_DAMAGE hooks */
+    FRAME_STAGE_EFFECTS_DAMAGE  = 1,
+    /* Trying to directly scan out a surface */
+    FRAME_STAGE_DIRECT_SCANOUT  = 2,
+    /* Acquiring a buffer from the swapchain and accumulating damage */
+    FRAME_STAGE_START_FRAME     = 3,
+    /* Generating render instructions from the scenegraph */
+    FRAME_STAGE_GATHER          = 4,
+    /* Executing the render instructions */
+    FRAME_STAGE_RENDER          = 5,
+    /* Running OUTPUT_EFFECT_OVERLAY hooks */
+    FRAME_STAGE_EFFECTS_OVERLAY = 6,
+    /* Running postprocessing effects */
+    FRAME_STAGE_POST_EFFECTS    = 7,
+    /* Rendering software cursors */
+    FRAME_STAGE_SW_CURSORS      = 8,
+    /* Submitting the frame to the output */
+    FRAME_STAGE_SWAP_BUFFERS    = 9,
+    /* Invalid stage, used internally */
+    FRAME_STAGE_TOTAL           = 10,
+};
+
+/**
+ * Timing information about a single frame of an output, as collected by the frame profiler
+ * (enabled with the core/frame_profiling option).
+ *
+ * All durations are in nanoseconds. Stages which were not executed in the frame have a duration of -1.
+ */
+struct frame_timings_t
+{
+    /* A counter which is incremented for each profiled frame on the output */
+    uint64_t sequence = 0;
+    /* Monotonic timestamp of the start of the frame */
+    int64_t start_ns = 0;
+    /* Duration of each stage, indexed by frame_profile_stage_t */
+    int64_t stage_ns[FRAME_STAGE_TOTAL];
+    /* Time the GPU needed to render the frame, or -1 if not (yet) available */
+    int64_t gpu_ns = -1;
+    /* Whether the frame was directly scanned out */
+    bool direct_scanout = false;
+};
+
 /**
  * The frame-done signal is emitted on an output when the frame has been completed (regardless of whether new
  * content was painted or not).
@@ -52,6 +101,18 @@ using post_hook_t = std::function<void (const wf::framebuffer_t& source,
 struct frame_done_signal
 {};
 
+/**
+ * The output-damage signal is emitted on an output whenever a part of it is damaged, for example by a view
+ * which committed new contents. The region is in output-local logical coordinates.
+ */
+struct output_damage_signal
+{
+    output_damage_signal(const wf::region_t& region) : region(region)
+    {}
+
+    const wf::region_t& region;
+};
+
 /** Render manager
  *
  * Each output has a render manager, which is responsible for all rendering
@@ -178,6 +239,15 @@ class render_manager
      */
     void set_require_depth_buffer(bool require);
 
+    /**
+     * Get the timings of the most recently painted frames on the output. Frames are only recorded while the
+     * core/frame_profiling option is enabled.
+     *
+     * @param max_frames The maximal number of frames to return.
+     * @return The newest frames, ordered from oldest to newest.
+     */
+    std::vector<frame_timings_t> get_frame_timings(size_t max_frames = -1) const;
+
   private:
     class impl;
     std::unique_ptr<impl> pimpl;
@@ -52,6 +52,25 @@ struct render_instruction_t
     std::any data = {};
 };
 
+/**
+ * A part of the scene which is shown on an output, described for the purpose of assigning hardware planes.
+ * See render_instance_t::collect_plane_candidates().
+ */
+struct plane_candidate_t
+{
+    /** The render instance which renders the content when it is composited. */
+    render_instance_t *instance = nullptr;
+    /**
+     * A buffer with the content which may be displayed on a plane as-is (i.e. with the same size, scale and
+     * transform as the output), or nullptr if the content has to be composited.
+     */
+    wlr_buffer *buffer = nullptr;
+    /** The area covered by the content, in output-local coordinates. */
+    wf::geometry_t geometry = {0, 0, 0, 0};
+    /** Whether the whole area is opaque. */
+    bool opaque = false;
+};
+
 /**
  * When (parts) of the scenegraph have to be rendered, they have to be
  * 'instantiated' first. The instantiation of a (sub)tree of the scenegraph
@@ -154,6 +173,23 @@ class render_instance_t
      */
     virtual void compute_visibility(wf::output_t *output, wf::region_t& visible)
     {}
+
+    /**
+     * Describe the content of the render instance and its children, so that parts of it can be shown on
+     * hardware planes of the output instead of being composited.
+     *
+     * Instances add their content to @candidates front to back, translated by @offset to output-local
+     * coordinates. Instances which do not render anything themselves only need to forward the call to their
+     * children.
+     *
+     * @return false if the instance cannot describe its content, for example because it applies arbitrary
+     *   transformations to its children. In this case, no planes are used for the output. This is the default.
+     */
+    virtual bool collect_plane_candidates(wf::output_t *output, std::vector<plane_candidate_t>& candidates,
+        wf::point_t offset)
+    {
+        return false;
+    }
 };
 
 using render_instance_uptr = std::unique_ptr<render_instance_t>;
@@ -287,6 +323,47 @@ direct_scanout try_scanout_from_list(
 void compute_visibility_from_list(const std::vector<render_instance_uptr>& instances, wf::output_t *output,
     wf::region_t& region, const wf::point_t& offset);
 
+/**
+ * A helper function for render instances with children. Calls collect_plane_candidates() on each instance,
+ * front to back, and returns false as soon as one of them fails.
+ */
+bool collect_plane_candidates_from_list(const std::vector<render_instance_uptr>& instances,
+    wf::output_t *output, std::vector<plane_candidate_t>& candidates, wf::point_t offset);
+
+/**
+ * An interface for nodes which know which parts of them are fully opaque.
+ *
+ * Render instances use it to cull the nodes below: after scheduling their own instructions, they subtract the
+ * opaque region from the damage, so that instances below which are fully covered do not get any instructions,
+ * and partially covered ones repaint less. See subtract_opaque_region().
+ */
+class opaque_region_node_t
+{
+  public:
+    virtual ~opaque_region_node_t() = default;
+
+    /**
+     * Get the opaque region of the node in its parent's coordinate system (same as get_bounding_box()).
+     */
+    virtual wf::region_t get_opaque_region() const
+    {
+        return {};
+    }
+};
+
+/**
+ * If @node implements opaque_region_node_t, subtract its opaque region from @damage.
+ * @damage should be in the node's parent coordinate system, as in render_instance_t::schedule_instructions().
+ */
+template<class Node>
+void subtract_opaque_region(Node *node, wf::region_t& damage)
+{
+    if (auto opaque = dynamic_cast<opaque_region_node_t*>(node))
+    {
+        damage ^= opaque->get_opaque_region();
+    }
+}
+
 /**
  * A helper class for easier implementation of render instances.
  * It automatically schedules instruction for the current node and tracks damage from the main node.
@@ -306,11 +383,31 @@ class simple_render_instance_t : public render_instance_t
     void schedule_instructions(std::vector<render_instruction_t>& instructions,
         const wf::render_target_t& target, wf::region_t& damage) override
     {
+        auto our_damage = damage & self->get_bounding_box();
+        if (our_damage.empty())
+        {
+            // Outside of the damage, or fully covered by opaque nodes above.
+            return;
+        }
+
         instructions.push_back(render_instruction_t{
                     .instance = this,
                     .target   = target,
-                    .damage   = damage & self->get_bounding_box(),
+                    .damage   = std::move(our_damage),
+                });
+
+        subtract_opaque_region(self.get(), damage);
+    }
+
+    bool collect_plane_candidates(wf::output_t *output, std::vector<plane_candidate_t>& candidates,
+        wf::point_t offset) override
+    {
+        // Simple instances render only inside their bounding box, but always need composition.
+        candidates.push_back(plane_candidate_t{
+                    .instance = this,
+                    .geometry = self->get_bounding_box() + offset,
                 });
+        return true;
     }
 
   protected:
@@ -334,5 +431,56 @@ struct node_regen_instances_signal
 {};
 
 uint32_t optimize_nested_render_instances(wf::scene::node_ptr node, uint32_t flags);
+
+/**
+ * A helper for render instances which keep a list with the render instances of their node's children, for
+ * example because they need to transform damage or render the children to an auxiliary buffer.
+ *
+ * Instead of throwing away the whole list when the children change (typically when the node receives a
+ * node_regen_instances_signal), the helper keeps the instances of children which are still enabled and whose
+ * subtree did not change since their instances were generated (see node_t::get_instances_serial()). Only new
+ * and changed children get new render instances, and the instances of removed or disabled children are
+ * destroyed.
+ *
+ * Each helper is supposed to be used by a single render instance (or the render manager of a single output),
+ * because the kept render instances still use the damage callback they were generated with.
+ */
+class incremental_instances_t
+{
+  public:
+    /**
+     * Update @instances so that they contain the render instances of all enabled children of @node, in
+     * order, as if gen_render_instances() was called on each of them.
+     *
+     * The list should not be modified by other code between two calls, otherwise all instances are
+     * regenerated.
+     */
+    void regen_children(std::vector<render_instance_uptr>& instances, node_t *node,
+        damage_callback push_damage, wf::output_t *shown_on);
+
+    /**
+     * Same as regen_children(), but the list also starts with a render instance for @node itself which
+     * forwards the node's damage, like the default implementation of node_t::gen_render_instances().
+     */
+    void regen_node(std::vector<render_instance_uptr>& instances, node_t *node,
+        damage_callback push_damage, wf::output_t *shown_on);
+
+  private:
+    struct child_entry_t
+    {
+        std::weak_ptr<node_t> node;
+        uint64_t serial;
+        size_t first;
+        size_t count;
+    };
+
+    node_t *last_node = nullptr;
+    bool with_self    = false;
+    size_t generated  = 0;
+    std::vector<child_entry_t> entries;
+
+    void regen(std::vector<render_instance_uptr>& instances, node_t *node,
+        damage_callback push_damage, wf::output_t *shown_on, bool add_self);
+};
 }
 }
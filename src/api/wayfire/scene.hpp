@@ -70,6 +70,7 @@ namespace scene
 class node_t;
 using node_ptr = std::shared_ptr<node_t>;
 using node_weak_ptr = std::weak_ptr<node_t>;
+struct input_index_t;
 
 /**
  * Describes the current state of a node.
@@ -351,6 +352,19 @@ class node_t : public std::enable_shared_from_this<node_t>,
      */
     virtual uint32_t optimize_update(uint32_t update_flags);
 
+    /**
+     * Get the serial of the last CHILDREN_LIST or ENABLED update which was propagated to this node, either
+     * because the node itself changed or because the change happened in its subtree and was not intercepted
+     * by optimize_update() along the way.
+     *
+     * Render instances which keep a list of the instances of their children use the serial to find out which
+     * children need new render instances, see @incremental_instances_t.
+     */
+    uint64_t get_instances_serial() const
+    {
+        return instances_serial;
+    }
+
   public:
     node_t(const node_t&) = delete;
     node_t(node_t&&) = delete;
@@ -359,10 +373,12 @@ class node_t : public std::enable_shared_from_this<node_t>,
 
   protected:
     bool _is_structure;
-    int enabled_counter = 1;
-    node_t *_parent     = nullptr;
+    int enabled_counter       = 1;
+    node_t *_parent           = nullptr;
+    uint64_t instances_serial = 0;
     friend class surface_root_node_t;
     friend class floating_inner_node_t;
+    friend void update(node_ptr changed_node, uint32_t flags);
 
     // A helper functions for stringify() implementations, serializes the flags()
     // to a string, e.g. node with KEYBOARD and USER_INPUT -> '(ku)'
@@ -378,6 +394,13 @@ class node_t : public std::enable_shared_from_this<node_t>,
     std::vector<std::shared_ptr<node_t>> children;
 
     void set_children_unchecked(std::vector<node_ptr> new_list);
+
+  private:
+    /**
+     * A spatial index over the children, used by the default find_node_at() implementation when the node
+     * has many children. Created on demand.
+     */
+    std::unique_ptr<input_index_t> input_index;
 };
 
 /**
@@ -435,6 +458,7 @@ class output_node_t : public floating_inner_node_t
 
     wf::geometry_t get_bounding_box() override;
     std::optional<input_node_t> find_node_at(const wf::pointf_t& at) override;
+    uint32_t optimize_update(uint32_t flags) override;
 
     /**
      * Get the output this node is responsible for.
@@ -519,6 +543,9 @@ void set_node_enabled(wf::scene::node_ptr node, bool enabled);
  * After updating the concrete node's state, the change is propagated to parent
  * nodes all the way up to the scenegraph's root.
  *
+ * A CHILDREN_LIST update is first offered to the changed node's own optimize_update(), so that nodes whose
+ * render instances regenerate their children locally do not need new render instances themselves.
+ *
  * @param changed_node The node whose state changed.
  * @param flags A bit mask consisting of flags defined in the @update_flag enum.
  */
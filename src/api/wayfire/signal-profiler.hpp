@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wf
+{
+namespace signal
+{
+/**
+ * Statistics about one signal handler. Connections with the same callback type (usually, a lambda defined at
+ * a particular place in the code) are counted together, so that handlers which exist once per view or per
+ * output show up as a single entry.
+ */
+struct listener_profile_t
+{
+    /* The plugin the handler belongs to, or "core" */
+    std::string owner;
+    /* The demangled type of the callback, which usually names the function where it was defined */
+    std::string callback;
+    /* How often the handler was called */
+    uint64_t calls = 0;
+    /* Total and maximal time spent in the handler, in nanoseconds */
+    int64_t total_ns = 0;
+    int64_t max_ns   = 0;
+};
+
+/**
+ * Statistics about one signal type.
+ */
+struct signal_profile_t
+{
+    /* The demangled name of the signal type */
+    std::string signal;
+    /* How often the signal was emitted on a provider with at least one connection */
+    uint64_t emissions = 0;
+    /* Total time spent in all handlers of the signal, in nanoseconds */
+    int64_t total_ns = 0;
+    /* The handlers of the signal, sorted by total time, most expensive first */
+    std::vector<listener_profile_t> listeners;
+};
+
+/**
+ * Get the statistics collected by the signal profiler, which is enabled with the core/signal_profiling
+ * option. Signals are sorted by the total time spent in their handlers, most expensive first.
+ */
+std::vector<signal_profile_t> get_signal_profile();
+
+/**
+ * Reset the statistics collected by the signal profiler.
+ */
+void reset_signal_profile();
+}
+}
@@ -1,18 +1,78 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 #include <wayfire/nonstd/safe-list.hpp>
 #include <cassert>
 #include <typeindex>
+#include <typeinfo>
 
 namespace wf
 {
 namespace signal
 {
 class provider_t;
+class connection_base_t;
+
+namespace detail
+{
+/**
+ * Get the numeric ID of the given signal type.
+ * IDs are assigned sequentially when a type is seen for the first time, so they stay the same for types
+ * which are used from several plugins. Types are compared with std::type_index and not by their name, since
+ * distinct types in anonymous namespaces can have the same name.
+ */
+uint32_t register_signal_type(const std::type_info& type);
+
+/** @return The (mangled) type name of the signal with the given ID. */
+const char *get_signal_type_name(uint32_t signal_id);
+
+/** Whether signal emissions are profiled, see wayfire/signal-profiler.hpp. */
+extern bool profiling_enabled;
+
+/** Record that the signal with the given ID was emitted. */
+void record_emission(uint32_t signal_id);
+
+/**
+ * Record how long a connection to the given signal took to handle it.
+ *
+ * @param callback_type The type of the callback of the connection, used to identify the handler and the
+ *   plugin it belongs to.
+ */
+void record_listener_call(uint32_t signal_id, const std::type_info& callback_type,
+    std::chrono::steady_clock::duration duration);
+
+/**
+ * The connections to one signal of a provider, in the order they were connected.
+ *
+ * Disconnecting a connection only replaces it with nullptr (a tombstone), so that connections can be
+ * removed in O(1) and while the signal is being emitted. The list is compacted once enough tombstones have
+ * accumulated and the signal is not being emitted.
+ */
+struct listener_list_t
+{
+    uint32_t signal_id;
+    std::vector<connection_base_t*> listeners;
+    size_t tombstones = 0;
+    int emitting = 0;
+};
+}
+
+/**
+ * @return The numeric ID of the given signal type. It is computed only once per type, so emitting a signal
+ * does not need RTTI.
+ */
+template<class SignalType>
+uint32_t get_signal_id()
+{
+    static const uint32_t id = detail::register_signal_type(typeid(SignalType));
+    return id;
+}
 
 /**
  * A base class for all connection_t, needed to store list of connections in a
@@ -36,19 +96,34 @@ class connection_base_t
 
     bool is_connected() const
     {
-        return !connected_to.empty();
+        return !slots.empty();
     }
 
     /** Disconnect from all connected signal providers */
     void disconnect();
 
+    /** @return The type of the callback, used to identify the connection when profiling signals. */
+    virtual const std::type_info& get_callback_type() const
+    {
+        return typeid(void);
+    }
+
   protected:
     connection_base_t()
     {}
 
     // Allow provider to deregister itself
     friend class provider_t;
-    std::unordered_set<provider_t*> connected_to;
+
+    /** The position of the connection in the listener list of a provider it is connected to. */
+    struct slot_t
+    {
+        provider_t *provider;
+        detail::listener_list_t *list;
+        size_t index;
+    };
+
+    std::vector<slot_t> slots;
 };
 
 /**
@@ -108,6 +183,11 @@ class connection_t final : public connection_base_t
         }
     }
 
+    const std::type_info& get_callback_type() const override
+    {
+        return current_callback.target_type();
+    }
+
   private:
     // Non-copyable and non-movable, as that would require updating/duplicating
     // the signal handler. But this is usually not what users of this API want.
@@ -137,31 +217,58 @@ class provider_t
     template<class SignalType>
     void connect(connection_t<SignalType> *callback)
     {
-        typed_connections[index<SignalType>()].push_back(callback);
-        callback->connected_to.insert(this);
+        auto list = find_list(get_signal_id<SignalType>(), true);
+        list->listeners.push_back(callback);
+        callback->slots.push_back({this, list, list->listeners.size() - 1});
     }
 
     /** Unregister a connection. */
     void disconnect(connection_base_t *callback)
     {
-        callback->connected_to.erase(this);
-        for (auto& [id, connected] : typed_connections)
+        auto& slots = callback->slots;
+        for (size_t i = slots.size(); i > 0; i--)
         {
-            connected.remove_all(callback);
+            if (slots[i - 1].provider == this)
+            {
+                auto slot = slots[i - 1];
+                slots.erase(slots.begin() + i - 1);
+                remove_listener(slot.list, slot.index);
+            }
         }
     }
 
-    /** Emit the given signal. */
+    /**
+     * Emit the given signal.
+     * Connections added while the signal is emitted are not called, connections removed while the signal
+     * is emitted are not called if they have not been called yet.
+     */
     template<class SignalType>
     void emit(SignalType *data)
     {
-        auto& conns = typed_connections[std::type_index(typeid(SignalType))];
-        conns.for_each([&] (connection_base_t *tc)
+        auto list = find_list(get_signal_id<SignalType>(), false);
+        if (!list)
+        {
+            return;
+        }
+
+        if (detail::profiling_enabled)
+        {
+            emit_profiled(list, data);
+            return;
+        }
+
+        ++list->emitting;
+        const size_t size = list->listeners.size();
+        for (size_t i = 0; i < size; i++)
         {
-            auto real_type = dynamic_cast<connection_t<SignalType>*>(tc);
-            assert(real_type);
-            real_type->emit(data);
-        });
+            if (auto listener = list->listeners[i])
+            {
+                static_cast<connection_t<SignalType>*>(listener)->emit(data);
+            }
+        }
+
+        --list->emitting;
+        try_compact(list);
     }
 
     provider_t()
@@ -169,12 +276,17 @@ class provider_t
 
     ~provider_t()
     {
-        for (auto& [id, connected] : typed_connections)
+        for (auto& list : lists)
         {
-            connected.for_each([&] (connection_base_t *base)
+            for (auto& listener : list->listeners)
             {
-                base->connected_to.erase(this);
-            });
+                if (listener)
+                {
+                    auto& slots = listener->slots;
+                    slots.erase(std::remove_if(slots.begin(), slots.end(),
+                        [&] (const auto& slot) { return slot.provider == this; }), slots.end());
+                }
+            }
         }
     }
 
@@ -188,13 +300,99 @@ class provider_t
 
   private:
     template<class SignalType>
-    static inline std::type_index index()
+    void emit_profiled(detail::listener_list_t *list, SignalType *data)
+    {
+        detail::record_emission(list->signal_id);
+
+        ++list->emitting;
+        const size_t size = list->listeners.size();
+        for (size_t i = 0; i < size; i++)
+        {
+            if (auto listener = list->listeners[i])
+            {
+                // The listener may be destroyed by its own callback, so its type is needed beforehand.
+                auto& callback_type = listener->get_callback_type();
+                auto start = std::chrono::steady_clock::now();
+                static_cast<connection_t<SignalType>*>(listener)->emit(data);
+                detail::record_listener_call(list->signal_id, callback_type,
+                    std::chrono::steady_clock::now() - start);
+            }
+        }
+
+        --list->emitting;
+        try_compact(list);
+    }
+
+    /**
+     * Find the listener list for the given signal. Objects usually have connections to only a few signals,
+     * so a linear search is faster than hashing.
+     */
+    detail::listener_list_t *find_list(uint32_t signal_id, bool create)
+    {
+        for (auto& list : lists)
+        {
+            if (list->signal_id == signal_id)
+            {
+                return list.get();
+            }
+        }
+
+        if (!create)
+        {
+            return nullptr;
+        }
+
+        lists.push_back(std::make_unique<detail::listener_list_t>());
+        lists.back()->signal_id = signal_id;
+        return lists.back().get();
+    }
+
+    void remove_listener(detail::listener_list_t *list, size_t index)
     {
-        return std::type_index(typeid(SignalType));
+        list->listeners[index] = nullptr;
+        ++list->tombstones;
+        try_compact(list);
+    }
+
+    /** Remove tombstones from the list if there are enough of them and the list is not being iterated. */
+    void try_compact(detail::listener_list_t *list)
+    {
+        if (list->emitting || (list->tombstones * 2 < list->listeners.size()))
+        {
+            return;
+        }
+
+        auto& listeners = list->listeners;
+        size_t alive    = 0;
+        for (size_t i = 0; i < listeners.size(); i++)
+        {
+            auto listener = listeners[i];
+            if (!listener)
+            {
+                continue;
+            }
+
+            if (i != alive)
+            {
+                listeners[alive] = listener;
+                for (auto& slot : listener->slots)
+                {
+                    if ((slot.list == list) && (slot.index == i))
+                    {
+                        slot.index = alive;
+                        break;
+                    }
+                }
+            }
+
+            ++alive;
+        }
+
+        listeners.resize(alive);
+        list->tombstones = 0;
     }
 
-    std::unordered_map<std::type_index, wf::safe_list_t<connection_base_t*>>
-    typed_connections;
+    std::vector<std::unique_ptr<detail::listener_list_t>> lists;
 };
 }
 }
@@ -40,6 +40,27 @@ class transaction_manager_t : public signal::provider_t
      */
     void schedule_object(transaction_object_sptr object);
 
+    /**
+     * Start a batch: until the matching end_batch(), all scheduled transactions are merged into a single
+     * transaction, so that their objects are applied atomically. This is useful when a single logical
+     * operation (e.g. rearranging multiple views) is done in multiple steps.
+     *
+     * Batches may be nested, the merged transaction is scheduled when the outermost batch ends.
+     */
+    void begin_batch();
+
+    /**
+     * End a batch started with begin_batch().
+     */
+    void end_batch();
+
+    /**
+     * Set the apply scheduler used for all transactions committed from now on, see
+     * transaction_t::set_apply_scheduler(). An empty scheduler applies transactions as soon as they are
+     * ready.
+     */
+    void set_apply_scheduler(transaction_t::apply_scheduler_t scheduler);
+
     /**
      * Check whether there is a pending transaction for the given object.
      */
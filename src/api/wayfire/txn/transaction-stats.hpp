@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wf
+{
+namespace txn
+{
+/**
+ * A histogram of latencies with exponentially growing buckets: bucket i counts latencies below
+ * get_bucket_limit_us(i), the last bucket counts everything else.
+ */
+struct latency_histogram_t
+{
+    static constexpr int NR_BUCKETS = 12;
+    std::array<uint64_t, NR_BUCKETS> buckets = {};
+    uint64_t count   = 0;
+    int64_t total_us = 0;
+    int64_t max_us   = 0;
+
+    /** @return The exclusive upper limit of the given bucket in microseconds, or -1 for the last bucket. */
+    static int64_t get_bucket_limit_us(int bucket);
+
+    /** Add a latency to the histogram. */
+    void add(int64_t latency_us);
+};
+
+/**
+ * Statistics about the objects of a given type, for example, xdg-shell toplevels.
+ */
+struct object_type_stats_t
+{
+    /* The demangled name of the object type */
+    std::string type;
+    /* Time from the commit of a transaction until the object became ready */
+    latency_histogram_t ready_latency;
+    /* How often the object did not become ready before the transaction timed out */
+    uint64_t timeouts = 0;
+};
+
+/**
+ * A transaction which timed out, together with the objects which were late.
+ */
+struct timed_out_transaction_t
+{
+    /* Time from commit to apply */
+    int64_t duration_us = 0;
+    /* The objects which were not ready, see transaction_object_t::stringify() */
+    std::vector<std::string> late_objects;
+};
+
+struct transaction_stats_t
+{
+    /* The number of applied transactions, and how many of them timed out */
+    uint64_t applied   = 0;
+    uint64_t timed_out = 0;
+    /* Time a transaction waited for conflicting transactions, from schedule until commit */
+    latency_histogram_t schedule_to_commit;
+    /* Time a transaction waited for its objects, from commit until apply */
+    latency_histogram_t commit_to_apply;
+    /* Statistics for each type of transaction object, slowest first (by maximal latency) */
+    std::vector<object_type_stats_t> object_types;
+    /* The most recent transactions which timed out, oldest first */
+    std::vector<timed_out_transaction_t> recent_timeouts;
+};
+
+/**
+ * Get latency statistics about all transactions applied since startup or since the last reset.
+ */
+transaction_stats_t get_transaction_stats();
+
+/**
+ * Reset the transaction statistics.
+ */
+void reset_transaction_stats();
+}
+}
@@ -3,11 +3,34 @@
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/util.hpp"
 #include <wayfire/txn/transaction-object.hpp>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace wf
 {
 namespace txn
 {
+/**
+ * Timestamps from the lifecycle of a transaction. They are aggregated into the statistics available via
+ * wf::txn::get_transaction_stats() when the transaction is applied.
+ */
+struct transaction_trace_t
+{
+    using time_point_t = std::chrono::steady_clock::time_point;
+
+    /**
+     * When the transaction was scheduled. Filled in by the transaction manager. If transactions are merged,
+     * this is the time the earliest of them was scheduled.
+     */
+    time_point_t scheduled;
+    time_point_t committed;
+    time_point_t applied;
+
+    /** When each object became ready. Objects which are missing did not become ready before the timeout. */
+    std::unordered_map<const transaction_object_t*, time_point_t> ready;
+};
+
 /**
  * A transaction contains one or more transaction objects whose state should be applied atomically, that is,
  * changes to the objects should be applied only after all the objects are ready to apply the changes.
@@ -50,14 +73,43 @@ class transaction_t : public signal::provider_t
      */
     void commit();
 
+    /**
+     * Get the timestamps recorded so far for the transaction.
+     */
+    transaction_trace_t& get_trace();
+
+    /**
+     * A function which decides when a transaction whose objects are all ready is applied. It is given the
+     * transaction and a callback which applies it, and may call the callback right away or later, for
+     * example at the start of the next frame. The callback is a no-op if the transaction has been applied
+     * in the meantime (because it timed out) or destroyed.
+     */
+    using apply_scheduler_t = std::function<void (transaction_t*, std::function<void()>)>;
+
+    /**
+     * Set the apply scheduler of the transaction. By default, transactions are applied as soon as all
+     * objects are ready. A timeout always applies the transaction immediately.
+     */
+    void set_apply_scheduler(apply_scheduler_t scheduler);
+
     virtual ~transaction_t() = default;
 
   private:
     std::vector<transaction_object_sptr> objects;
+    // The same objects as @objects, so that adding an object does not need to search the whole list.
+    std::unordered_set<transaction_object_t*> object_set;
+    transaction_trace_t trace;
     int count_ready_objects = 0;
     uint64_t timeout;
     timer_setter_t timer_setter;
 
+    apply_scheduler_t apply_scheduler;
+    bool apply_scheduled = false;
+    bool applied = false;
+    // Expires when the transaction is destroyed, so that deferred apply callbacks can detect it.
+    std::shared_ptr<bool> alive_token = std::make_shared<bool>(true);
+
+    void request_apply();
     void apply(bool did_timeout);
     wf::signal::connection_t<object_ready_signal> on_object_ready;
 };
@@ -44,6 +44,7 @@ class translation_node_instance_t : public render_instance_t
 {
   protected:
     std::vector<render_instance_uptr> children;
+    incremental_instances_t children_regen;
     damage_callback push_damage;
     std::shared_ptr<translation_node_t> self;
     wf::signal::connection_t<wf::scene::node_damage_signal> on_node_damage;
@@ -62,6 +63,8 @@ class translation_node_instance_t : public render_instance_t
     void presentation_feedback(wf::output_t *output) override;
     wf::scene::direct_scanout try_scanout(wf::output_t *output) override;
     void compute_visibility(wf::output_t *output, wf::region_t& visible) override;
+    bool collect_plane_candidates(wf::output_t *output, std::vector<plane_candidate_t>& candidates,
+        wf::point_t offset) override;
 };
 }
 }
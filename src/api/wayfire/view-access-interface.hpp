@@ -2,6 +2,7 @@
 
 #include "wayfire/condition/access_interface.hpp"
 #include "wayfire/view.hpp"
+#include <optional>
 #include <string>
 #include <tuple>
 
@@ -56,7 +57,8 @@ class view_access_interface_t : public access_interface_t
     /**
      * @brief set_view Setter for the view to interrogate.
      *
-     * @param[in] view The view to assign.
+     * @param[in] view The view to assign. This also drops the cached string
+     *   properties, so it should be called again if the view may have changed.
      */
     void set_view(wayfire_view view);
 
@@ -66,5 +68,17 @@ class view_access_interface_t : public access_interface_t
      * @brief _view The view to interrogate.
      */
     wayfire_view _view;
+
+    /**
+     * @brief _cached_strings The string properties of the view, computed on
+     * first use. Conditions of many rules are typically evaluated against the
+     * same view, and these properties do not change while they are evaluated.
+     */
+    struct
+    {
+        std::optional<std::string> app_id;
+        std::optional<std::string> title;
+        std::optional<std::string> type;
+    } _cached_strings;
 };
 } // End namespace wf.
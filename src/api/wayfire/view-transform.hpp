@@ -28,20 +28,6 @@ class zero_copy_texturable_node_t
     }
 };
 
-class opaque_region_node_t
-{
-  public:
-    virtual ~opaque_region_node_t() = default;
-
-    /**
-     * Get the opaque region of the node in its parent's coordinate system (same as get_bounding_box()).
-     */
-    virtual wf::region_t get_opaque_region() const
-    {
-        return {};
-    }
-};
-
 /**
  * A base class for all transformer nodes.
  * It facilitates the reuse of auxilliary buffers between render instances.
@@ -149,6 +135,7 @@ class transformer_render_instance_t : public render_instance_t
 
     // A list of render instances of the next transformer or the view itself.
     std::vector<render_instance_uptr> children;
+    incremental_instances_t children_regen;
 
     /**
      * Get a texture which contains the contents of the children nodes.
@@ -221,10 +208,7 @@ class transformer_render_instance_t : public render_instance_t
             _push_damage(region);
         };
 
-        for (auto& ch : self->get_children())
-        {
-            ch->gen_render_instances(children, push_damage_child, _shown_on);
-        }
+        children_regen.regen_children(children, self.get(), push_damage_child, _shown_on);
     }
 
     ~transformer_render_instance_t()
@@ -237,11 +221,18 @@ class transformer_render_instance_t : public render_instance_t
         if (!damage.empty())
         {
             auto our_damage = damage & self->get_bounding_box();
+            if (our_damage.empty())
+            {
+                return;
+            }
+
             instructions.push_back(wf::scene::render_instruction_t{
                         .instance = this,
                         .target   = target,
                         .damage   = std::move(our_damage),
                     });
+
+            subtract_opaque_region(self.get(), damage);
         }
     }
 
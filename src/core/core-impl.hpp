@@ -2,6 +2,8 @@
 #define WF_CORE_CORE_IMPL_HPP
 
 #include "core/plugin-loader.hpp"
+#include "core/signal-profiler.hpp"
+#include "core/txn/frame-sync.hpp"
 #include "wayfire/core.hpp"
 #include "wayfire/scene-input.hpp"
 #include "wayfire/scene.hpp"
@@ -22,6 +24,8 @@ class compositor_core_impl_t : public compositor_core_t
     std::unique_ptr<wf::input_manager_t> input;
     std::unique_ptr<input_method_relay> im_relay;
     std::unique_ptr<plugin_manager_t> plugin_mgr;
+    std::unique_ptr<signal::signal_profiler_t> signal_profiler;
+    std::unique_ptr<txn::frame_sync_t> tx_frame_sync;
 
     /**
      * Initialize the compositor core.
@@ -212,6 +212,8 @@ void wf::compositor_core_impl_t::init()
     wlr_single_pixel_buffer_manager_v1_create(display);
 
     this->bindings = std::make_unique<bindings_repository_t>();
+    this->signal_profiler = std::make_unique<signal::signal_profiler_t>();
+    this->tx_frame_sync   = std::make_unique<txn::core_frame_sync_t>();
     image_io::init();
     OpenGL::init();
     this->state = compositor_state_t::START_BACKEND;
@@ -271,6 +273,7 @@ void wf::compositor_core_impl_t::fini()
     im_relay.reset();
     seat.reset();
     input.reset();
+    tx_frame_sync.reset();
     priv_output_layout_fini(output_layout.get());
     output_layout.reset();
     tx_manager.reset();
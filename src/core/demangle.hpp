@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cxxabi.h>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace wf
+{
+/**
+ * @return The demangled form of a type name as returned by std::type_info::name(), or the name itself if it
+ *   cannot be demangled.
+ */
+inline std::string demangle_type_name(const char *name)
+{
+    int status = 0;
+    std::unique_ptr<char, decltype(&free)> demangled{
+        abi::__cxa_demangle(name, nullptr, nullptr, &status), &free};
+    return (status == 0) ? demangled.get() : name;
+}
+}
@@ -0,0 +1,83 @@
+#include "input-grid.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+wf::scene::input_grid_t::input_grid_t(const std::vector<std::optional<wf::geometry_t>>& boxes)
+{
+    this->boxes.resize(boxes.size(), {0, 0, 0, 0});
+
+    int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        if (!boxes[i])
+        {
+            unbounded.push_back(i);
+            continue;
+        }
+
+        this->boxes[i] = *boxes[i];
+        if ((boxes[i]->width <= 0) || (boxes[i]->height <= 0))
+        {
+            // Empty boxes never contain a point, so they do not need to be added to any cell.
+            continue;
+        }
+
+        x1 = std::min(x1, boxes[i]->x);
+        y1 = std::min(y1, boxes[i]->y);
+        x2 = std::max(x2, boxes[i]->x + boxes[i]->width);
+        y2 = std::max(y2, boxes[i]->y + boxes[i]->height);
+    }
+
+    if (x1 > x2)
+    {
+        return;
+    }
+
+    bounds = {x1, y1, x2 - x1, y2 - y1};
+
+    cell_width  = std::max(1, (bounds.width + MAX_CELLS_PER_AXIS - 1) / MAX_CELLS_PER_AXIS);
+    cell_height = std::max(1, (bounds.height + MAX_CELLS_PER_AXIS - 1) / MAX_CELLS_PER_AXIS);
+    columns     = (bounds.width + cell_width - 1) / cell_width;
+    rows = (bounds.height + cell_height - 1) / cell_height;
+    cells.resize(columns * rows);
+
+    for (uint32_t i = 0; i < this->boxes.size(); i++)
+    {
+        const auto& box = this->boxes[i];
+        if (!boxes[i] || (box.width <= 0) || (box.height <= 0))
+        {
+            continue;
+        }
+
+        // The right and bottom edges are included, so that points on them end up in the cell as well,
+        // whether or not the box itself considers them inside.
+        const int first_column = (box.x - bounds.x) / cell_width;
+        const int last_column  = std::min(columns - 1, (box.x + box.width - bounds.x) / cell_width);
+        const int first_row    = (box.y - bounds.y) / cell_height;
+        const int last_row     = std::min(rows - 1, (box.y + box.height - bounds.y) / cell_height);
+        for (int row = first_row; row <= last_row; row++)
+        {
+            for (int column = first_column; column <= last_column; column++)
+            {
+                cells[row * columns + column].push_back(i);
+            }
+        }
+    }
+}
+
+const std::vector<uint32_t>& wf::scene::input_grid_t::cell_at(const wf::pointf_t& point) const
+{
+    static const std::vector<uint32_t> no_entries;
+
+    const double x = std::floor(point.x) - bounds.x;
+    const double y = std::floor(point.y) - bounds.y;
+    if ((x < 0) || (y < 0) || (x > bounds.width) || (y > bounds.height) || cells.empty())
+    {
+        return no_entries;
+    }
+
+    const int column = std::min(columns - 1, (int)x / cell_width);
+    const int row    = std::min(rows - 1, (int)y / cell_height);
+    return cells[row * columns + column];
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <wayfire/geometry.hpp>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace wf
+{
+namespace scene
+{
+/**
+ * A uniform grid over a list of boxes, used to find the boxes which contain a point without testing each of
+ * them in turn.
+ *
+ * Boxes are identified by their index in the list the grid was built from. A box may also be std::nullopt,
+ * in which case it is considered unbounded, i.e. it is a candidate for every point.
+ */
+class input_grid_t
+{
+  public:
+    input_grid_t(const std::vector<std::optional<wf::geometry_t>>& boxes);
+
+    /**
+     * Call @callback with the index of each box which contains @point, in increasing order of the indices,
+     * until the callback returns true.
+     *
+     * @return Whether the callback returned true.
+     */
+    template<class Callback>
+    bool for_each_candidate(const wf::pointf_t& point, Callback&& callback) const
+    {
+        const auto& cell = cell_at(point);
+
+        // Merge the entries of the cell with the unbounded boxes, to preserve the order of the indices.
+        size_t i = 0, j = 0;
+        while ((i < cell.size()) || (j < unbounded.size()))
+        {
+            uint32_t next;
+            if ((j >= unbounded.size()) || ((i < cell.size()) && (cell[i] < unbounded[j])))
+            {
+                next = cell[i++];
+                if (!(boxes[next] & point))
+                {
+                    continue;
+                }
+            } else
+            {
+                next = unbounded[j++];
+            }
+
+            if (callback(next))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+  private:
+    /** The number of cells per axis is limited, so that large boxes do not end up in too many cells. */
+    static constexpr int MAX_CELLS_PER_AXIS = 16;
+
+    wf::geometry_t bounds = {0, 0, 0, 0};
+    int cell_width  = 1;
+    int cell_height = 1;
+    int columns     = 0;
+    int rows = 0;
+
+    std::vector<wf::geometry_t> boxes;
+    std::vector<std::vector<uint32_t>> cells;
+    std::vector<uint32_t> unbounded;
+
+    const std::vector<uint32_t>& cell_at(const wf::pointf_t& point) const;
+};
+}
+}
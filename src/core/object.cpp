@@ -2,18 +2,44 @@
 #include "wayfire/nonstd/safe-list.hpp"
 #include <unordered_map>
 #include <set>
+#include <string>
+#include <typeindex>
+#include <vector>
 
 #include <wayfire/signal-provider.hpp>
 
 void wf::signal::connection_base_t::disconnect()
 {
-    auto connected_copy = this->connected_to;
-    for (auto& x : connected_copy)
+    // provider_t::disconnect() removes all slots of the provider.
+    while (!slots.empty())
     {
-        x->disconnect(this);
+        slots.back().provider->disconnect(this);
     }
 }
 
+static std::vector<std::string>& signal_type_names()
+{
+    static std::vector<std::string> names;
+    return names;
+}
+
+uint32_t wf::signal::detail::register_signal_type(const std::type_info& type)
+{
+    static std::unordered_map<std::type_index, uint32_t> ids;
+    auto [it, inserted] = ids.try_emplace(std::type_index(type), ids.size());
+    if (inserted)
+    {
+        signal_type_names().push_back(type.name());
+    }
+
+    return it->second;
+}
+
+const char *wf::signal::detail::get_signal_type_name(uint32_t signal_id)
+{
+    return signal_type_names().at(signal_id).c_str();
+}
+
 class wf::object_base_t::obase_impl
 {
   public:
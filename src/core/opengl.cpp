@@ -7,6 +7,8 @@
 #include "config.h"
 #include <wayfire/nonstd/wlroots-full.hpp>
 #include <set>
+#include <algorithm>
+#include <iterator>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -109,6 +111,9 @@ GLuint compile_program(std::string vertex_source, std::string frag_source)
     return (s == GL_FALSE) ? 0 : result_program;
 }
 
+/* Vertex buffer used by draw_cached_clipped() */
+static GLuint clipped_quads_vbo = 0;
+
 void init()
 {
     render_begin();
@@ -119,6 +124,7 @@ void init()
     color_program.set_simple(compile_program(default_vertex_shader_source,
         color_rect_fragment_source));
 
+    GL_CALL(glGenBuffers(1, &clipped_quads_vbo));
     render_end();
 }
 
@@ -127,6 +133,8 @@ void fini()
     render_begin();
     program.free_resources();
     color_program.free_resources();
+    GL_CALL(glDeleteBuffers(1, &clipped_quads_vbo));
+    clipped_quads_vbo = 0;
     render_end();
 }
 
@@ -151,6 +159,11 @@ void unbind_output(wf::output_t *output)
 std::vector<GLfloat> vertexData;
 std::vector<GLfloat> coordData;
 
+/* The quad and texture coordinates of the last render_transformed_texture() call, for draw_cached_clipped() */
+static gl_geometry cached_geometry;
+static gl_geometry cached_texg;
+static std::vector<GLfloat> clipped_quads_data;
+
 void render_transformed_texture(wf::texture_t tex,
     const gl_geometry& g, const gl_geometry& texg,
     glm::mat4 model, glm::vec4 color, uint32_t bits)
@@ -189,6 +202,9 @@ void render_transformed_texture(wf::texture_t tex,
         final_texg.x1, final_texg.y2,
     };
 
+    cached_geometry = g;
+    cached_texg     = final_texg;
+
     program.set_active_texture(tex);
     program.attrib_pointer("position", 2, 0, vertexData.data());
     program.attrib_pointer("uvPosition", 2, 0, coordData.data());
@@ -212,6 +228,64 @@ void draw_cached()
     GL_CALL(glDrawArrays(GL_TRIANGLE_FAN, 0, 4));
 }
 
+void draw_cached_clipped(const wf::region_t& region)
+{
+    const auto& g = cached_geometry;
+    const auto& t = cached_texg;
+    if ((g.x1 >= g.x2) || (g.y1 >= g.y2))
+    {
+        return;
+    }
+
+    // Texture coordinates are a linear function of the vertex coordinates, see the vertex order in
+    // render_transformed_texture(): (x1, y2) maps to (t.x1, t.y1) and (x2, y1) maps to (t.x2, t.y2).
+    auto tex_x = [&] (float x) { return t.x1 + (t.x2 - t.x1) * (x - g.x1) / (g.x2 - g.x1); };
+    auto tex_y = [&] (float y) { return t.y1 + (t.y2 - t.y1) * (g.y2 - y) / (g.y2 - g.y1); };
+
+    clipped_quads_data.clear();
+    for (const auto& rect : region)
+    {
+        const float x1 = std::max<float>(rect.x1, g.x1);
+        const float y1 = std::max<float>(rect.y1, g.y1);
+        const float x2 = std::min<float>(rect.x2, g.x2);
+        const float y2 = std::min<float>(rect.y2, g.y2);
+        if ((x1 >= x2) || (y1 >= y2))
+        {
+            continue;
+        }
+
+        // Two triangles, with interleaved position and texture coordinates
+        const GLfloat quad[] = {
+            x1, y2, tex_x(x1), tex_y(y2),
+            x2, y2, tex_x(x2), tex_y(y2),
+            x2, y1, tex_x(x2), tex_y(y1),
+            x1, y2, tex_x(x1), tex_y(y2),
+            x2, y1, tex_x(x2), tex_y(y1),
+            x1, y1, tex_x(x1), tex_y(y1),
+        };
+
+        clipped_quads_data.insert(clipped_quads_data.end(), std::begin(quad), std::end(quad));
+    }
+
+    if (clipped_quads_data.empty())
+    {
+        return;
+    }
+
+    const GLsizei stride = 4 * sizeof(GLfloat);
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, clipped_quads_vbo));
+    GL_CALL(glBufferData(GL_ARRAY_BUFFER, clipped_quads_data.size() * sizeof(GLfloat),
+        clipped_quads_data.data(), GL_STREAM_DRAW));
+    program.attrib_pointer("position", 2, stride, (void*)0);
+    program.attrib_pointer("uvPosition", 2, stride, (void*)(2 * sizeof(GLfloat)));
+    GL_CALL(glDrawArrays(GL_TRIANGLES, 0, clipped_quads_data.size() / 4));
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    // Restore the client-side arrays, so that draw_cached() can still be used afterwards.
+    program.attrib_pointer("position", 2, 0, vertexData.data());
+    program.attrib_pointer("uvPosition", 2, 0, coordData.data());
+}
+
 void clear_cached()
 {
     disable_gl_call = false;
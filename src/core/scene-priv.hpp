@@ -1,5 +1,6 @@
 #pragma once
 #include <wayfire/scene.hpp>
+#include "input-grid.hpp"
 
 
 namespace wf
@@ -8,5 +9,46 @@ namespace scene
 {
 struct root_node_t::priv_t
 {};
+
+/**
+ * The state of the spatial index of a node's children, see node_t::find_node_at().
+ *
+ * Only children which are views are indexed by their bounding box: other nodes (for example input grabs or
+ * lock surfaces) may accept input outside of their bounding box, so they are tested for every point.
+ *
+ * The index does not track changes of individual nodes. Instead, all indices are invalidated whenever the
+ * scenegraph is updated or a node on an output is damaged (see output_render_instance_t), which covers
+ * any change of the children's geometry, even by transformers which do not trigger an update. Since this
+ * may happen for every pointer motion (e.g. with software cursors), the index is rebuilt only if it is
+ * queried more than once before the next change.
+ */
+struct input_index_t
+{
+    /** Do not index nodes with fewer children, testing them in turn is cheap enough. */
+    static constexpr size_t MIN_CHILDREN = 8;
+
+    uint64_t generation = 0;
+    int nr_queries = 0;
+    std::optional<input_grid_t> grid;
+
+    /**
+     * Get the grid over @children, or nullptr if the children should be tested in turn.
+     */
+    const input_grid_t *get_grid(const std::vector<node_ptr>& children);
+};
+
+/**
+ * Invalidate the spatial indices of all nodes.
+ */
+void invalidate_input_indices();
+
+/**
+ * Get the nodes of all views (i.e. nodes which are a view_node_tag_t) in the scenegraph, in the order in
+ * which they are found when walking the scenegraph from top to bottom, so that views higher in the stacking
+ * order come first.
+ *
+ * The list is cached and recomputed only after the list of children of a node changes.
+ */
+const std::vector<node_t*>& get_view_stacking_order();
 }
 }
@@ -4,6 +4,8 @@
 #include <wayfire/view.hpp>
 #include <wayfire/output.hpp>
 #include <algorithm>
+#include <iterator>
+#include <unordered_map>
 
 #include "scene-priv.hpp"
 #include "wayfire/geometry.hpp"
@@ -71,17 +73,107 @@ std::string node_t::stringify_flags() const
     return "(" + fl + ")";
 }
 
+static uint64_t input_index_generation = 1;
+
+void invalidate_input_indices()
+{
+    ++input_index_generation;
+}
+
+const input_grid_t*input_index_t::get_grid(const std::vector<node_ptr>& children)
+{
+    if (generation != input_index_generation)
+    {
+        generation = input_index_generation;
+        nr_queries = 0;
+        grid.reset();
+    }
+
+    if (!grid && (++nr_queries > 1))
+    {
+        std::vector<std::optional<wf::geometry_t>> boxes;
+        boxes.reserve(children.size());
+        for (auto& child : children)
+        {
+            if (dynamic_cast<view_node_tag_t*>(child.get()))
+            {
+                boxes.push_back(child->get_bounding_box());
+            } else
+            {
+                boxes.push_back(std::nullopt);
+            }
+        }
+
+        grid.emplace(boxes);
+    }
+
+    return grid ? &grid.value() : nullptr;
+}
+
+static bool view_stacking_order_dirty = true;
+
+static void collect_view_nodes(node_t *node, std::vector<node_t*>& result)
+{
+    if (dynamic_cast<view_node_tag_t*>(node))
+    {
+        result.push_back(node);
+    }
+
+    for (auto& child : node->get_children())
+    {
+        collect_view_nodes(child.get(), result);
+    }
+}
+
+const std::vector<node_t*>& get_view_stacking_order()
+{
+    static std::vector<node_t*> view_stacking_order;
+    if (view_stacking_order_dirty)
+    {
+        view_stacking_order.clear();
+        collect_view_nodes(wf::get_core().scene().get(), view_stacking_order);
+        view_stacking_order_dirty = false;
+    }
+
+    return view_stacking_order;
+}
+
 std::optional<input_node_t> node_t::find_node_at(const wf::pointf_t& at)
 {
     auto local = this->to_local(at);
-    for (auto& node : get_children())
+    auto try_child = [&] (const node_ptr& node) -> std::optional<input_node_t>
     {
         if (!node->is_enabled())
         {
-            continue;
+            return {};
         }
 
-        auto child_node = node->find_node_at(local);
+        return node->find_node_at(local);
+    };
+
+    if (children.size() >= input_index_t::MIN_CHILDREN)
+    {
+        if (!input_index)
+        {
+            input_index = std::make_unique<input_index_t>();
+        }
+
+        if (auto grid = input_index->get_grid(children))
+        {
+            std::optional<input_node_t> result;
+            grid->for_each_candidate(local, [&] (uint32_t idx)
+            {
+                result = try_child(children[idx]);
+                return result.has_value();
+            });
+
+            return result;
+        }
+    }
+
+    for (auto& node : get_children())
+    {
+        auto child_node = try_child(node);
         if (child_node.has_value())
         {
             return child_node;
@@ -123,6 +215,8 @@ bool floating_inner_node_t::set_children_list(std::vector<node_ptr> new_list)
 
 void node_t::set_children_unchecked(std::vector<node_ptr> new_list)
 {
+    invalidate_input_indices();
+    view_stacking_order_dirty = true;
     node_damage_signal data;
     data.region |= get_bounding_box();
 
@@ -234,6 +328,13 @@ class default_render_instance_t : public render_instance_t
         // from being scanned out.
         return direct_scanout::SKIP;
     }
+
+    bool collect_plane_candidates(wf::output_t *output, std::vector<plane_candidate_t>& candidates,
+        wf::point_t offset) override
+    {
+        // Nothing to render here
+        return true;
+    }
 };
 
 void node_t::gen_render_instances(std::vector<render_instance_uptr> & instances,
@@ -331,31 +432,43 @@ class output_render_instance_t : public default_render_instance_t
     wf::output_t *output;
     output_node_t *self;
     std::vector<render_instance_uptr> children;
+    incremental_instances_t children_regen;
+
+    wf::signal::connection_t<node_regen_instances_signal> on_regen_instances = [=] (auto)
+    {
+        regen_instances();
+    };
+
+    damage_callback push_damage_child;
+    wf::output_t *shown_on;
+
+    void regen_instances()
+    {
+        children_regen.regen_children(children, self, push_damage_child, shown_on);
+    }
 
   public:
     output_render_instance_t(output_node_t *self, damage_callback callback,
         wf::output_t *output, wf::output_t *shown_on) :
         default_render_instance_t(self, transform_damage(callback))
     {
-        this->self   = self;
-        this->output = output;
+        this->self     = self;
+        this->output   = output;
+        this->shown_on = shown_on;
 
         // Children are stored as a sublist, because we need to translate every
         // time between global and output-local geometry.
-        for (auto& child : self->get_children())
-        {
-            if (child->is_enabled())
-            {
-                child->gen_render_instances(children,
-                    transform_damage(callback), shown_on);
-            }
-        }
+        this->push_damage_child = transform_damage(callback);
+        regen_instances();
+        self->connect(&on_regen_instances);
     }
 
     damage_callback transform_damage(damage_callback child_damage)
     {
         return [=] (const wf::region_t& damage)
         {
+            // Anything that changes on the output may change the result of find_node_at() as well.
+            invalidate_input_indices();
             child_damage(damage + wf::origin(output->get_layout_geometry()));
         };
     }
@@ -425,6 +538,19 @@ class output_render_instance_t : public default_render_instance_t
         auto offset = wf::origin(output->get_layout_geometry());
         compute_visibility_from_list(children, output, visible, offset);
     }
+
+    bool collect_plane_candidates(wf::output_t *scanout, std::vector<plane_candidate_t>& candidates,
+        wf::point_t offset) override
+    {
+        if ((scanout != this->output) && this->self->limit_region)
+        {
+            // Not visible on the other output
+            return true;
+        }
+
+        offset = offset + wf::origin(output->get_layout_geometry());
+        return collect_plane_candidates_from_list(children, scanout, candidates, offset);
+    }
 };
 
 void output_node_t::gen_render_instances(
@@ -444,6 +570,13 @@ void output_node_t::gen_render_instances(
             shown_on));
 }
 
+uint32_t output_node_t::optimize_update(uint32_t flags)
+{
+    // The output's render instances keep a list of the children's instances anyway, so they can update it
+    // locally, without regenerating the instances of the whole scenegraph.
+    return optimize_nested_render_instances(shared_from_this(), flags);
+}
+
 wf::geometry_t output_node_t::get_bounding_box()
 {
     const auto bbox = node_t::get_bounding_box();
@@ -493,36 +626,61 @@ void set_node_enabled(wf::scene::node_ptr node, bool enabled)
 
 void update(node_ptr changed_node, uint32_t flags)
 {
-    if ((flags & update_flag::CHILDREN_LIST) ||
-        (flags & update_flag::ENABLED) ||
-        (flags & update_flag::GEOMETRY))
+    static uint64_t last_instances_serial = 0;
+    invalidate_input_indices();
+    if (flags & update_flag::CHILDREN_LIST)
     {
-        flags |= update_flag::INPUT_STATE;
+        // Nodes whose render instances keep track of their children's instances can handle changes to their
+        // own list of children locally, in which case the node itself does not need new render instances.
+        const uint32_t local = changed_node->optimize_update(update_flag::CHILDREN_LIST);
+        if (!(local & update_flag::CHILDREN_LIST))
+        {
+            flags = (flags & ~update_flag::CHILDREN_LIST) | local | update_flag::INPUT_STATE;
+        }
     }
 
-    if (!changed_node->is_enabled() &&
-        !(flags & update_flag::ENABLED))
+    while (true)
     {
-        flags |= update_flag::MASKED;
-    }
+        if (flags & (update_flag::CHILDREN_LIST | update_flag::ENABLED))
+        {
+            // Mark the node as needing new render instances. The serial is propagated to the parents as long
+            // as they do not optimize the update away, see incremental_instances_t.
+            changed_node->instances_serial = ++last_instances_serial;
+        }
 
-    if (changed_node == wf::get_core().scene())
-    {
-        root_node_update_signal data;
-        data.flags = flags;
-        wf::get_core().scene()->emit(&data);
-        return;
-    }
+        if ((flags & update_flag::CHILDREN_LIST) ||
+            (flags & update_flag::ENABLED) ||
+            (flags & update_flag::GEOMETRY))
+        {
+            flags |= update_flag::INPUT_STATE;
+        }
+
+        if (!changed_node->is_enabled() &&
+            !(flags & update_flag::ENABLED))
+        {
+            flags |= update_flag::MASKED;
+        }
+
+        if (changed_node == wf::get_core().scene())
+        {
+            root_node_update_signal data;
+            data.flags = flags;
+            wf::get_core().scene()->emit(&data);
+            return;
+        }
+
+        if (!changed_node->parent())
+        {
+            return;
+        }
 
-    if (changed_node->parent())
-    {
         flags = changed_node->parent()->optimize_update(flags);
         if (!changed_node->parent()->is_enabled())
         {
             flags |= update_flag::MASKED;
         }
 
-        update(changed_node->parent()->shared_from_this(), flags);
+        changed_node = changed_node->parent()->shared_from_this();
     }
 }
 
@@ -549,5 +707,84 @@ uint32_t optimize_nested_render_instances(wf::scene::node_ptr node, uint32_t fla
 
     return flags;
 }
+
+void incremental_instances_t::regen_children(std::vector<render_instance_uptr>& instances, node_t *node,
+    damage_callback push_damage, wf::output_t *shown_on)
+{
+    regen(instances, node, push_damage, shown_on, false);
+}
+
+void incremental_instances_t::regen_node(std::vector<render_instance_uptr>& instances, node_t *node,
+    damage_callback push_damage, wf::output_t *shown_on)
+{
+    regen(instances, node, push_damage, shown_on, true);
+}
+
+void incremental_instances_t::regen(std::vector<render_instance_uptr>& instances, node_t *node,
+    damage_callback push_damage, wf::output_t *shown_on, bool add_self)
+{
+    auto old_instances = std::move(instances);
+    auto old_entries   = std::move(entries);
+    instances.clear();
+    entries.clear();
+
+    const bool can_reuse = (node == last_node) && (add_self == with_self) &&
+        (old_instances.size() == generated);
+    this->last_node = node;
+    this->with_self = add_self;
+
+    std::unordered_map<node_t*, const child_entry_t*> previous;
+    if (can_reuse)
+    {
+        for (auto& entry : old_entries)
+        {
+            if (auto child = entry.node.lock())
+            {
+                previous[child.get()] = &entry;
+            }
+        }
+    }
+
+    if (add_self)
+    {
+        if (can_reuse && !old_instances.empty())
+        {
+            instances.push_back(std::move(old_instances.front()));
+        } else
+        {
+            instances.push_back(std::make_unique<default_render_instance_t>(node, push_damage));
+        }
+    }
+
+    for (auto& ch : node->get_children())
+    {
+        if (!ch->is_enabled())
+        {
+            continue;
+        }
+
+        const size_t first = instances.size();
+        auto it = previous.find(ch.get());
+        if ((it != previous.end()) && (it->second->serial == ch->get_instances_serial()))
+        {
+            // Nothing changed in the child's subtree, keep its instances.
+            auto begin = old_instances.begin() + it->second->first;
+            std::move(begin, begin + it->second->count, std::back_inserter(instances));
+        } else
+        {
+            ch->gen_render_instances(instances, push_damage, shown_on);
+        }
+
+        entries.push_back(child_entry_t{
+                    .node   = ch,
+                    .serial = ch->get_instances_serial(),
+                    .first  = first,
+                    .count  = instances.size() - first,
+                });
+    }
+
+    // Instances of removed, disabled or changed children are destroyed together with old_instances.
+    this->generated = instances.size();
+}
 } // namespace scene
 }
@@ -4,6 +4,25 @@
 #include "hotspot-manager.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include <wayfire/debug.hpp>
+#include <unordered_map>
+
+namespace wf
+{
+/**
+ * The callbacks of all bindings which match a key or button combination.
+ */
+template<class Callback>
+struct binding_matches_t
+{
+    /** Key or button bindings, in the order they were added. */
+    std::vector<Callback*> bindings;
+    /** Activator bindings, in the order they were added. */
+    std::vector<activator_callback*> activators;
+};
+
+template<class Callback> using binding_index_t =
+    std::unordered_map<uint64_t, std::shared_ptr<const binding_matches_t<Callback>>>;
+}
 
 struct wf::bindings_repository_t::impl
 {
@@ -33,10 +52,28 @@ struct wf::bindings_repository_t::impl
     binding_container_t<wf::buttonbinding_t, button_callback> buttons;
     binding_container_t<wf::activatorbinding_t, activator_callback> activators;
 
+    /**
+     * The matching bindings for each key and button combination which was pressed, indexed by the modifiers
+     * and the key or button. A combination is looked up in all bindings only the first time it is pressed.
+     *
+     * The lists are shared, so that handlers can keep using them even if the index is invalidated while
+     * the callbacks run.
+     */
+    binding_index_t<key_callback> key_index;
+    binding_index_t<button_callback> button_index;
+
+    /** Drop the index, needed whenever bindings are added, removed or their options change. */
+    void invalidate_index()
+    {
+        key_index.clear();
+        button_index.clear();
+    }
+
     hotspot_manager_t hotspot_mgr;
 
     wf::signal::connection_t<wf::reload_config_signal> on_config_reload = [=] (wf::reload_config_signal *ev)
     {
+        invalidate_index();
         recreate_hotspots();
         reparse_extensions();
     };
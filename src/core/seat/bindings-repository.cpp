@@ -9,13 +9,57 @@ wf::bindings_repository_t::bindings_repository_t()
 }
 
 template<class Option, class Callback>
-static void push_binding(wf::binding_container_t<Option, Callback>& bindings,
-    wf::option_sptr_t<Option> opt, Callback *callback)
+static void push_binding(wf::bindings_repository_t::impl *priv,
+    wf::binding_container_t<Option, Callback>& bindings, wf::option_sptr_t<Option> opt, Callback *callback)
 {
     auto bnd = std::make_unique<wf::binding_t<Option, Callback>>();
     bnd->activated_by = opt;
     bnd->callback     = callback;
+    bnd->on_updated   = [priv] () { priv->invalidate_index(); };
+    opt->add_updated_handler(&bnd->on_updated);
     bindings.emplace_back(std::move(bnd));
+    priv->invalidate_index();
+}
+
+static uint64_t combination_hash(uint32_t modifiers, uint32_t code)
+{
+    return ((uint64_t)modifiers << 32) | code;
+}
+
+/**
+ * Get the callbacks of all bindings which match the pressed combination, looking them up in @bindings and
+ * @activators only if the combination is not in @index yet.
+ */
+template<class Option, class Callback>
+static std::shared_ptr<const wf::binding_matches_t<Callback>> find_matches(
+    wf::binding_index_t<Callback>& index, uint64_t hash, const Option& pressed,
+    const wf::binding_container_t<Option, Callback>& bindings,
+    const wf::binding_container_t<wf::activatorbinding_t, wf::activator_callback>& activators)
+{
+    auto& entry = index[hash];
+    if (!entry)
+    {
+        auto matches = std::make_shared<wf::binding_matches_t<Callback>>();
+        for (auto& binding : bindings)
+        {
+            if (binding->activated_by->get_value() == pressed)
+            {
+                matches->bindings.push_back(binding->callback);
+            }
+        }
+
+        for (auto& binding : activators)
+        {
+            if (binding->activated_by->get_value().has_match(pressed))
+            {
+                matches->activators.push_back(binding->callback);
+            }
+        }
+
+        entry = std::move(matches);
+    }
+
+    return entry;
 }
 
 wf::bindings_repository_t::~bindings_repository_t()
@@ -23,23 +67,23 @@ wf::bindings_repository_t::~bindings_repository_t()
 
 void wf::bindings_repository_t::add_key(option_sptr_t<keybinding_t> key, wf::key_callback *cb)
 {
-    push_binding(priv->keys, key, cb);
+    push_binding(priv.get(), priv->keys, key, cb);
 }
 
 void wf::bindings_repository_t::add_axis(option_sptr_t<keybinding_t> axis, wf::axis_callback *cb)
 {
-    push_binding(priv->axes, axis, cb);
+    push_binding(priv.get(), priv->axes, axis, cb);
 }
 
 void wf::bindings_repository_t::add_button(option_sptr_t<buttonbinding_t> button, wf::button_callback *cb)
 {
-    push_binding(priv->buttons, button, cb);
+    push_binding(priv.get(), priv->buttons, button, cb);
 }
 
 void wf::bindings_repository_t::add_activator(
     option_sptr_t<activatorbinding_t> activator, wf::activator_callback *cb)
 {
-    push_binding(priv->activators, activator, cb);
+    push_binding(priv.get(), priv->activators, activator, cb);
     if (activator->get_value().get_hotspots().size())
     {
         priv->recreate_hotspots();
@@ -54,50 +98,33 @@ bool wf::bindings_repository_t::handle_key(const wf::keybinding_t& pressed,
         return false;
     }
 
-    std::vector<std::function<bool()>> callbacks;
-    for (auto& binding : this->priv->keys)
+    /* Keep a reference to the matches, the callbacks might add or remove bindings */
+    auto matches = find_matches(priv->key_index, combination_hash(pressed.get_modifiers(), pressed.get_key()),
+        pressed, priv->keys, priv->activators);
+
+    bool handled = false;
+    for (auto callback : matches->bindings)
     {
-        if (binding->activated_by->get_value() == pressed)
-        {
-            /* We must be careful because the callback might be erased,
-             * so force copy the callback into the lambda */
-            auto callback = binding->callback;
-            callbacks.emplace_back([pressed, callback] ()
-            {
-                return (*callback)(pressed);
-            });
-        }
+        handled |= (*callback)(pressed);
     }
 
-    for (auto& binding : this->priv->activators)
+    if (!matches->activators.empty())
     {
-        if (binding->activated_by->get_value().has_match(pressed))
-        {
-            /* We must be careful because the callback might be erased,
-             * so force copy the callback into the lambda */
-            auto callback = binding->callback;
-            callbacks.emplace_back([pressed, callback, mod_binding_key] ()
-            {
-                wf::activator_data_t ev = {
-                    .source = activator_source_t::KEYBINDING,
-                    .activation_data = pressed.get_key()
-                };
+        wf::activator_data_t ev = {
+            .source = activator_source_t::KEYBINDING,
+            .activation_data = pressed.get_key()
+        };
 
-                if (mod_binding_key)
-                {
-                    ev.source = activator_source_t::MODIFIERBINDING;
-                    ev.activation_data = mod_binding_key;
-                }
-
-                return (*callback)(ev);
-            });
+        if (mod_binding_key)
+        {
+            ev.source = activator_source_t::MODIFIERBINDING;
+            ev.activation_data = mod_binding_key;
         }
-    }
 
-    bool handled = false;
-    for (auto& cb : callbacks)
-    {
-        handled |= cb();
+        for (auto callback : matches->activators)
+        {
+            handled |= (*callback)(ev);
+        }
     }
 
     return handled;
@@ -136,45 +163,30 @@ bool wf::bindings_repository_t::handle_button(const wf::buttonbinding_t& pressed
         return false;
     }
 
-    std::vector<std::function<bool()>> callbacks;
-    for (auto& binding : this->priv->buttons)
+    /* Keep a reference to the matches, the callbacks might add or remove bindings */
+    auto matches = find_matches(priv->button_index,
+        combination_hash(pressed.get_modifiers(), pressed.get_button()),
+        pressed, priv->buttons, priv->activators);
+
+    bool binding_handled = false;
+    for (auto callback : matches->bindings)
     {
-        if (binding->activated_by->get_value() == pressed)
-        {
-            /* We must be careful because the callback might be erased,
-             * so force copy the callback into the lambda */
-            auto callback = binding->callback;
-            callbacks.emplace_back([=] ()
-            {
-                return (*callback)(pressed);
-            });
-        }
+        binding_handled |= (*callback)(pressed);
     }
 
-    for (auto& binding : this->priv->activators)
+    if (!matches->activators.empty())
     {
-        if (binding->activated_by->get_value().has_match(pressed))
+        wf::activator_data_t data = {
+            .source = activator_source_t::BUTTONBINDING,
+            .activation_data = pressed.get_button(),
+        };
+
+        for (auto callback : matches->activators)
         {
-            /* We must be careful because the callback might be erased,
-             * so force copy the callback into the lambda */
-            auto callback = binding->callback;
-            callbacks.emplace_back([=] ()
-            {
-                wf::activator_data_t data = {
-                    .source = activator_source_t::BUTTONBINDING,
-                    .activation_data = pressed.get_button(),
-                };
-                return (*callback)(data);
-            });
+            binding_handled |= (*callback)(data);
         }
     }
 
-    bool binding_handled = false;
-    for (auto call : callbacks)
-    {
-        binding_handled |= call();
-    }
-
     return binding_handled;
 }
 
@@ -262,6 +274,7 @@ void wf::bindings_repository_t::rem_binding(void *callback)
     erase(priv->buttons);
     erase(priv->axes);
     erase(priv->activators);
+    priv->invalidate_index();
 
     if (update_hotspots)
     {
@@ -10,6 +10,7 @@
 #include <wayfire/util/log.hpp>
 #include <wayfire/core.hpp>
 #include <wayfire/output-layout.hpp>
+#include <wayfire/output.hpp>
 
 wf::pointer_t::pointer_t(nonstd::observer_ptr<wf::input_manager_t> input,
     nonstd::observer_ptr<seat_t> seat)
@@ -206,6 +207,7 @@ void wf::pointer_t::grab_surface(wf::scene::node_ptr node)
 void wf::pointer_t::handle_pointer_button(wlr_pointer_button_event *ev,
     input_event_processing_mode_t mode)
 {
+    flush_pending_motion();
     seat->priv->break_mod_bindings();
     bool handled_in_binding = (mode != input_event_processing_mode_t::FULL);
 
@@ -308,12 +310,64 @@ void wf::pointer_t::send_motion(uint32_t time_msec)
     }
 }
 
+/** @return The duration of a frame of the output under the cursor, in milliseconds. */
+static uint32_t get_frame_duration_ms()
+{
+    auto gc = wf::get_core().get_cursor_position();
+    auto output = wf::get_core().output_layout->get_output_at(gc.x, gc.y);
+    if (output && (output->handle->refresh > 0))
+    {
+        return std::max(1, 1000000 / output->handle->refresh);
+    }
+
+    return 16;
+}
+
+void wf::pointer_t::handle_motion(int64_t time_msec)
+{
+    // With buttons held, the motion is typically a drag or a stroke in a drawing application, which need
+    // every event.
+    if (!coalesce_motion || has_pressed_buttons())
+    {
+        pending_motion_time.reset();
+        motion_flush_timer.disconnect();
+        update_cursor_position(time_msec);
+        return;
+    }
+
+    if (!pending_motion_time.has_value())
+    {
+        motion_flush_timer.set_timeout(get_frame_duration_ms(), [=] ()
+        {
+            flush_pending_motion();
+        });
+    }
+
+    pending_motion_time = time_msec;
+}
+
+void wf::pointer_t::flush_pending_motion()
+{
+    if (!pending_motion_time.has_value())
+    {
+        return;
+    }
+
+    auto time_msec = *pending_motion_time;
+    pending_motion_time.reset();
+    motion_flush_timer.disconnect();
+
+    update_cursor_position(time_msec);
+    // The frame event of the deferred motion was skipped in handle_pointer_frame().
+    wlr_seat_pointer_notify_frame(seat->seat);
+}
+
 void wf::pointer_t::handle_pointer_motion(wlr_pointer_motion_event *ev,
     input_event_processing_mode_t mode)
 {
     /* XXX: maybe warp directly? */
     wlr_cursor_move(seat->priv->cursor->cursor, &ev->pointer->base, ev->delta_x, ev->delta_y);
-    update_cursor_position(ev->time_msec);
+    handle_motion(ev->time_msec);
 }
 
 void wf::pointer_t::handle_pointer_motion_absolute(
@@ -333,12 +387,13 @@ void wf::pointer_t::handle_pointer_motion_absolute(
 
     // TODO: indirection via wf_cursor
     wlr_cursor_warp_closest(seat->priv->cursor->cursor, NULL, cx, cy);
-    update_cursor_position(ev->time_msec);
+    handle_motion(ev->time_msec);
 }
 
 void wf::pointer_t::handle_pointer_axis(wlr_pointer_axis_event *ev,
     input_event_processing_mode_t mode)
 {
+    flush_pending_motion();
     bool handled_in_binding = wf::get_core().bindings->handle_axis(
         seat->priv->get_modifiers(), ev);
     seat->priv->break_mod_bindings();
@@ -367,6 +422,7 @@ void wf::pointer_t::handle_pointer_axis(wlr_pointer_axis_event *ev,
 void wf::pointer_t::handle_pointer_swipe_begin(wlr_pointer_swipe_begin_event *ev,
     input_event_processing_mode_t mode)
 {
+    flush_pending_motion();
     wlr_pointer_gestures_v1_send_swipe_begin(
         wf::get_core().protocols.pointer_gestures, seat->seat,
         ev->time_msec, ev->fingers);
@@ -391,6 +447,7 @@ void wf::pointer_t::handle_pointer_swipe_end(wlr_pointer_swipe_end_event *ev,
 void wf::pointer_t::handle_pointer_pinch_begin(wlr_pointer_pinch_begin_event *ev,
     input_event_processing_mode_t mode)
 {
+    flush_pending_motion();
     wlr_pointer_gestures_v1_send_pinch_begin(
         wf::get_core().protocols.pointer_gestures, seat->seat,
         ev->time_msec, ev->fingers);
@@ -415,6 +472,7 @@ void wf::pointer_t::handle_pointer_pinch_end(wlr_pointer_pinch_end_event *ev,
 void wf::pointer_t::handle_pointer_hold_begin(wlr_pointer_hold_begin_event *ev,
     input_event_processing_mode_t mode)
 {
+    flush_pending_motion();
     wlr_pointer_gestures_v1_send_hold_begin(
         wf::get_core().protocols.pointer_gestures, seat->seat,
         ev->time_msec, ev->fingers);
@@ -430,5 +488,11 @@ void wf::pointer_t::handle_pointer_hold_end(wlr_pointer_hold_end_event *ev,
 
 void wf::pointer_t::handle_pointer_frame()
 {
+    if (pending_motion_time.has_value())
+    {
+        // Sent together with the deferred motion.
+        return;
+    }
+
     wlr_seat_pointer_notify_frame(seat->seat);
 }
@@ -144,6 +144,21 @@ class pointer_t
      * Send synthetic button release events to the old cursor focus.
      */
     void send_leave_to_focus(wf::scene::node_ptr old_focus);
+
+    /**
+     * With input/coalesce_pointer_motion, the cursor moves with every motion event, but updating the focus
+     * and sending motion to the focused node is deferred until the next frame. The time of the last
+     * deferred motion event is stored until then.
+     */
+    wf::option_wrapper_t<bool> coalesce_motion{"input/coalesce_pointer_motion"};
+    std::optional<int64_t> pending_motion_time;
+    wf::wl_timer<false> motion_flush_timer;
+
+    /** Update the cursor position after a motion event, possibly deferring the update. */
+    void handle_motion(int64_t time_msec);
+
+    /** Process deferred motion, if any. Needs to happen before other events are sent to the focus. */
+    void flush_pending_motion();
 };
 }
 
@@ -0,0 +1,190 @@
+#include "signal-profiler.hpp"
+#include "demangle.hpp"
+#include <wayfire/signal-profiler.hpp>
+#include <wayfire/signal-provider.hpp>
+#include <wayfire/util/log.hpp>
+#include <algorithm>
+#include <dlfcn.h>
+#include <map>
+
+bool wf::signal::detail::profiling_enabled = false;
+
+namespace
+{
+struct listener_stats_t
+{
+    /** The demangled name of the callback, resolved when the listener is first seen. */
+    std::string callback;
+    uint64_t calls = 0;
+    int64_t total_ns = 0;
+    int64_t max_ns   = 0;
+};
+
+struct signal_stats_t
+{
+    uint64_t emissions = 0;
+    /**
+     * Listeners are keyed by their owner and the (mangled) name of the callback type, and not by the address
+     * of the type information, because a plugin which is reloaded may get the addresses of another plugin.
+     */
+    std::map<std::pair<std::string, std::string>, listener_stats_t> listeners;
+};
+
+std::vector<signal_stats_t>& get_stats()
+{
+    static std::vector<signal_stats_t> stats;
+    return stats;
+}
+
+signal_stats_t& get_signal_stats(uint32_t signal_id)
+{
+    auto& stats = get_stats();
+    if (signal_id >= stats.size())
+    {
+        stats.resize(signal_id + 1);
+    }
+
+    return stats[signal_id];
+}
+
+/**
+ * Find the plugin which contains the code of the given callback type, based on the shared object its type
+ * information is in. Lambdas are local types, so their type information is emitted in the plugin which
+ * defines them.
+ */
+std::string find_owner(const std::type_info& callback_type)
+{
+    Dl_info info, core_info;
+    if (!dladdr(&callback_type, &info) || !info.dli_fname)
+    {
+        return "unknown";
+    }
+
+    if (dladdr((void*)&wf::signal::detail::register_signal_type, &core_info) &&
+        (info.dli_fbase == core_info.dli_fbase))
+    {
+        return "core";
+    }
+
+    std::string name = info.dli_fname;
+    name = name.substr(name.find_last_of('/') + 1);
+    if (name.rfind("lib", 0) == 0)
+    {
+        name = name.substr(3);
+    }
+
+    return name.substr(0, name.find(".so"));
+}
+}
+
+void wf::signal::detail::record_emission(uint32_t signal_id)
+{
+    ++get_signal_stats(signal_id).emissions;
+}
+
+void wf::signal::detail::record_listener_call(uint32_t signal_id, const std::type_info& callback_type,
+    std::chrono::steady_clock::duration duration)
+{
+    const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    auto& listeners  = get_signal_stats(signal_id).listeners;
+    auto& listener   = listeners[{find_owner(callback_type), callback_type.name()}];
+    if (listener.calls == 0)
+    {
+        listener.callback = demangle_type_name(callback_type.name());
+    }
+
+    ++listener.calls;
+    listener.total_ns += ns;
+    listener.max_ns    = std::max(listener.max_ns, ns);
+}
+
+std::vector<wf::signal::signal_profile_t> wf::signal::get_signal_profile()
+{
+    std::vector<signal_profile_t> result;
+    auto& stats = get_stats();
+    for (uint32_t id = 0; id < stats.size(); id++)
+    {
+        if (stats[id].emissions == 0)
+        {
+            continue;
+        }
+
+        signal_profile_t profile;
+        profile.signal    = demangle_type_name(detail::get_signal_type_name(id));
+        profile.emissions = stats[id].emissions;
+        for (auto& [key, listener] : stats[id].listeners)
+        {
+            listener_profile_t entry;
+            entry.owner    = key.first;
+            entry.callback = listener.callback;
+            entry.calls    = listener.calls;
+            entry.total_ns = listener.total_ns;
+            entry.max_ns   = listener.max_ns;
+            profile.total_ns += listener.total_ns;
+            profile.listeners.push_back(entry);
+        }
+
+        std::sort(profile.listeners.begin(), profile.listeners.end(), [] (const auto& a, const auto& b)
+        {
+            return a.total_ns > b.total_ns;
+        });
+        result.push_back(profile);
+    }
+
+    std::sort(result.begin(), result.end(), [] (const auto& a, const auto& b)
+    {
+        return a.total_ns > b.total_ns;
+    });
+    return result;
+}
+
+void wf::signal::reset_signal_profile()
+{
+    get_stats().clear();
+}
+
+wf::signal::signal_profiler_t::signal_profiler_t()
+{
+    enabled.set_callback([=] () { update_state(); });
+    log_interval.set_callback([=] () { update_state(); });
+    update_state();
+}
+
+wf::signal::signal_profiler_t::~signal_profiler_t()
+{
+    detail::profiling_enabled = false;
+}
+
+void wf::signal::signal_profiler_t::update_state()
+{
+    detail::profiling_enabled = enabled;
+    log_timer.disconnect();
+    if (enabled && (log_interval > 0))
+    {
+        log_timer.set_timeout(log_interval * 1000, [=] ()
+        {
+            log_summary();
+            return true;
+        });
+    }
+}
+
+void wf::signal::signal_profiler_t::log_summary()
+{
+    static constexpr size_t MAX_SIGNALS   = 5;
+    static constexpr size_t MAX_LISTENERS = 3;
+
+    auto profile = get_signal_profile();
+    LOGI("Signal profile: ", profile.size(), " signals emitted since profiling was enabled or reset");
+    for (size_t i = 0; i < std::min(profile.size(), MAX_SIGNALS); i++)
+    {
+        auto& signal = profile[i];
+        LOGI("  ", signal.signal, ": ", signal.emissions, " emissions, ", signal.total_ns / 1000, "us total");
+        for (size_t j = 0; j < std::min(signal.listeners.size(), MAX_LISTENERS); j++)
+        {
+            auto& listener = signal.listeners[j];
+            LOGI("    [", listener.owner, "] ", listener.callback, ": ", listener.calls, " calls, ",
+                listener.total_ns / 1000, "us total, ", listener.max_ns / 1000, "us max");
+        }
+    }
+}
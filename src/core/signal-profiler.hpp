@@ -0,0 +1,29 @@
+#pragma once
+
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/util.hpp>
+
+namespace wf
+{
+namespace signal
+{
+/**
+ * Enables and disables signal profiling according to the core/signal_profiling option, and periodically logs
+ * the most expensive signal handlers while profiling is enabled.
+ */
+class signal_profiler_t
+{
+  public:
+    signal_profiler_t();
+    ~signal_profiler_t();
+
+  private:
+    wf::option_wrapper_t<bool> enabled{"core/signal_profiling"};
+    wf::option_wrapper_t<int> log_interval{"core/signal_profiling_log_interval"};
+    wf::wl_timer<true> log_timer;
+
+    void update_state();
+    void log_summary();
+};
+}
+}
@@ -0,0 +1,211 @@
+#include "frame-sync.hpp"
+#include <algorithm>
+#include <iterator>
+#include <wayfire/core.hpp>
+#include <wayfire/output.hpp>
+#include <wayfire/output-layout.hpp>
+#include <wayfire/toplevel.hpp>
+#include <wayfire/toplevel-view.hpp>
+#include <wayfire/txn/transaction-manager.hpp>
+#include <wayfire/nonstd/wlroots-full.hpp>
+
+void wf::txn::frame_sync_t::schedule_apply(transaction_t *tx, std::function<void()> apply)
+{
+    auto outputs = find_affected_outputs(tx);
+    for (auto it = outputs.begin(); it != outputs.end();)
+    {
+        it = is_producing_frames(*it) ? std::next(it) : outputs.erase(it);
+    }
+
+    if (outputs.empty())
+    {
+        // Nothing visible changes, or there is no frame to wait for.
+        apply();
+        return;
+    }
+
+    for (auto& output : outputs)
+    {
+        requested.insert(output);
+        request_frame(output);
+    }
+
+    deferred.push_back({std::move(outputs), std::move(apply)});
+}
+
+void wf::txn::frame_sync_t::apply_for_output(wf::output_t *output)
+{
+    apply_matching([&] (const deferred_apply_t& entry) { return entry.outputs.count(output); });
+}
+
+void wf::txn::frame_sync_t::check_stopped_outputs()
+{
+    for (auto& entry : deferred)
+    {
+        for (auto it = entry.outputs.begin(); it != entry.outputs.end();)
+        {
+            it = is_producing_frames(*it) ? std::next(it) : entry.outputs.erase(it);
+        }
+    }
+
+    apply_matching([&] (const deferred_apply_t& entry) { return entry.outputs.empty(); });
+}
+
+void wf::txn::frame_sync_t::apply_all()
+{
+    apply_matching([&] (const deferred_apply_t&) { return true; });
+}
+
+void wf::txn::frame_sync_t::apply_matching(std::function<bool(const deferred_apply_t&)> pred)
+{
+    std::vector<std::function<void()>> to_apply;
+    auto it = std::remove_if(deferred.begin(), deferred.end(), [&] (deferred_apply_t& entry)
+    {
+        if (pred(entry))
+        {
+            to_apply.push_back(std::move(entry.apply));
+            return true;
+        }
+
+        return false;
+    });
+    deferred.erase(it, deferred.end());
+
+    // Applying may commit and complete further transactions, which are then deferred again.
+    for (auto& apply : to_apply)
+    {
+        apply();
+    }
+
+    cancel_unused_requests();
+}
+
+void wf::txn::frame_sync_t::cancel_unused_requests()
+{
+    for (auto it = requested.begin(); it != requested.end();)
+    {
+        wf::output_t *output = *it;
+        const bool used = std::any_of(deferred.begin(), deferred.end(), [&] (const deferred_apply_t& entry)
+        {
+            return entry.outputs.count(output);
+        });
+
+        if (used)
+        {
+            ++it;
+        } else
+        {
+            it = requested.erase(it);
+            cancel_frame_request(output);
+        }
+    }
+}
+
+// ---------------------------------------- core_frame_sync_t -----------------------------------------
+wf::txn::core_frame_sync_t::core_frame_sync_t()
+{
+    on_output_removed = [=] (wf::output_pre_remove_signal *ev)
+    {
+        // The output will not render anymore, so nothing should wait for it.
+        apply_for_output(ev->output);
+        hooks.erase(ev->output);
+    };
+
+    on_configuration_changed = [=] (wf::output_layout_configuration_changed_signal*)
+    {
+        // Outputs which were turned off (or had DPMS enabled) do not start new frames.
+        check_stopped_outputs();
+    };
+
+    wf::get_core().output_layout->connect(&on_output_removed);
+    wf::get_core().output_layout->connect(&on_configuration_changed);
+    enabled.set_callback([=] () { update_state(); });
+    update_state();
+}
+
+wf::txn::core_frame_sync_t::~core_frame_sync_t()
+{
+    wf::get_core().tx_manager->set_apply_scheduler(nullptr);
+    apply_all();
+}
+
+void wf::txn::core_frame_sync_t::update_state()
+{
+    if (enabled)
+    {
+        // Committed transactions keep the scheduler, and may outlive this object during shutdown.
+        std::weak_ptr<bool> alive = alive_token;
+        auto scheduler = [this, alive] (transaction_t *tx, std::function<void()> apply)
+        {
+            if (alive.expired())
+            {
+                apply();
+            } else
+            {
+                schedule_apply(tx, std::move(apply));
+            }
+        };
+
+        wf::get_core().tx_manager->set_apply_scheduler(scheduler);
+    } else
+    {
+        // Transactions which are already committed keep the scheduler, so they are still applied on the
+        // next frame.
+        wf::get_core().tx_manager->set_apply_scheduler(nullptr);
+    }
+}
+
+std::set<wf::output_t*> wf::txn::core_frame_sync_t::find_affected_outputs(transaction_t *tx)
+{
+    std::set<wf::output_t*> outputs;
+    for (auto& obj : tx->get_objects())
+    {
+        auto toplevel = std::dynamic_pointer_cast<wf::toplevel_t>(obj);
+        if (!toplevel)
+        {
+            continue;
+        }
+
+        auto view = wf::find_view_for_toplevel(toplevel);
+        if (view && view->get_output())
+        {
+            outputs.insert(view->get_output());
+        }
+    }
+
+    return outputs;
+}
+
+bool wf::txn::core_frame_sync_t::is_producing_frames(wf::output_t *output)
+{
+    // Disabled outputs, including outputs with DPMS enabled, do not receive frame events.
+    return output->handle->enabled;
+}
+
+void wf::txn::core_frame_sync_t::request_frame(wf::output_t *output)
+{
+    auto& hook = hooks[output];
+    if (!hook)
+    {
+        hook = std::make_unique<output_hook_t>();
+        hook->hook = [=] () { apply_for_output(output); };
+    }
+
+    if (!hook->installed)
+    {
+        output->render->add_effect(&hook->hook, wf::OUTPUT_EFFECT_PRE);
+        hook->installed = true;
+    }
+
+    output->render->schedule_redraw();
+}
+
+void wf::txn::core_frame_sync_t::cancel_frame_request(wf::output_t *output)
+{
+    auto it = hooks.find(output);
+    if ((it != hooks.end()) && it->second->installed)
+    {
+        output->render->rem_effect(&it->second->hook);
+        it->second->installed = false;
+    }
+}
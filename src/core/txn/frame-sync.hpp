@@ -0,0 +1,112 @@
+#pragma once
+
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/render-manager.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include <wayfire/txn/transaction.hpp>
+#include <map>
+#include <set>
+
+namespace wf
+{
+namespace txn
+{
+/**
+ * Defers applying transactions which became ready until the start of the next frame of any of the outputs
+ * they affect, so that all transactions which became ready since the last frame are applied together and no
+ * frame shows a half-applied layout.
+ *
+ * Outputs which do not produce frames (for example, disabled outputs or outputs with DPMS off) are not waited
+ * for, otherwise the transactions would wait until they time out.
+ *
+ * The outputs themselves are accessed only via the virtual functions below, see core_frame_sync_t for the
+ * implementation used by core.
+ */
+class frame_sync_t
+{
+  public:
+    virtual ~frame_sync_t() = default;
+
+    /**
+     * Apply the transaction at the start of the next frame of an affected output, or immediately if none of
+     * the affected outputs produces frames.
+     */
+    void schedule_apply(transaction_t *tx, std::function<void()> apply);
+
+    /** Apply all deferred transactions which affect the given output. */
+    void apply_for_output(wf::output_t *output);
+
+    /** Apply the deferred transactions which wait only for outputs which stopped producing frames. */
+    void check_stopped_outputs();
+
+    /** Apply all deferred transactions. */
+    void apply_all();
+
+  protected:
+    /** @return The outputs on which the transaction's changes are visible. */
+    virtual std::set<wf::output_t*> find_affected_outputs(transaction_t *tx) = 0;
+
+    /** @return Whether the output is going to start a new frame when asked to. */
+    virtual bool is_producing_frames(wf::output_t *output) = 0;
+
+    /**
+     * Make sure that the output starts a new frame and that apply_for_output() is called when it does.
+     * Called each time a transaction is deferred until the next frame of the output.
+     */
+    virtual void request_frame(wf::output_t *output) = 0;
+
+    /** Called when there are no more deferred transactions for an output. */
+    virtual void cancel_frame_request(wf::output_t *output) = 0;
+
+  private:
+    struct deferred_apply_t
+    {
+        std::set<wf::output_t*> outputs;
+        std::function<void()> apply;
+    };
+
+    std::vector<deferred_apply_t> deferred;
+    std::set<wf::output_t*> requested;
+
+    void apply_matching(std::function<bool(const deferred_apply_t&)> pred);
+    void cancel_unused_requests();
+};
+
+/**
+ * The frame sync used by core when the core/transaction_frame_sync option is enabled. It applies deferred
+ * transactions in an OUTPUT_EFFECT_PRE hook of the outputs their views are on.
+ */
+class core_frame_sync_t : public frame_sync_t
+{
+  public:
+    core_frame_sync_t();
+    ~core_frame_sync_t();
+
+  protected:
+    std::set<wf::output_t*> find_affected_outputs(transaction_t *tx) override;
+    bool is_producing_frames(wf::output_t *output) override;
+    void request_frame(wf::output_t *output) override;
+    void cancel_frame_request(wf::output_t *output) override;
+
+  private:
+    wf::option_wrapper_t<bool> enabled{"core/transaction_frame_sync"};
+    void update_state();
+
+    struct output_hook_t
+    {
+        wf::effect_hook_t hook;
+        bool installed = false;
+    };
+
+    /**
+     * The effect hooks of outputs, installed while the output has deferred transactions. Hooks are kept
+     * until the output is removed, because they are uninstalled from inside the hook itself.
+     */
+    std::map<wf::output_t*, std::unique_ptr<output_hook_t>> hooks;
+
+    wf::signal::connection_t<wf::output_pre_remove_signal> on_output_removed;
+    wf::signal::connection_t<wf::output_layout_configuration_changed_signal> on_configuration_changed;
+    std::shared_ptr<bool> alive_token = std::make_shared<bool>(true);
+};
+}
+}
@@ -1,20 +1,11 @@
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/txn/transaction.hpp"
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include <wayfire/txn/transaction-manager.hpp>
 #include <wayfire/debug.hpp>
 
-static bool transactions_intersect(const wf::txn::transaction_uptr& a, const wf::txn::transaction_uptr& b)
-{
-    const auto& obj_a = a->get_objects();
-    const auto& obj_b = b->get_objects();
-
-    return std::any_of(obj_a.begin(), obj_a.end(), [&] (const wf::txn::transaction_object_sptr& x)
-    {
-        return std::find(obj_b.begin(), obj_b.end(), x) != obj_b.end();
-    });
-}
-
 struct wf::txn::transaction_manager_t::impl
 {
     impl()
@@ -25,6 +16,10 @@ struct wf::txn::transaction_manager_t::impl
     void schedule_transaction(transaction_uptr tx)
     {
         LOGC(TXN, "Scheduling transaction ", tx.get());
+        if (tx->get_trace().scheduled == transaction_trace_t::time_point_t{})
+        {
+            tx->get_trace().scheduled = std::chrono::steady_clock::now();
+        }
 
         // Step 1: add any objects which are directly or indirectly connected to the objects in tx
         coalesce_transactions(tx);
@@ -33,39 +28,62 @@ struct wf::txn::transaction_manager_t::impl
         remove_conflicts(tx);
 
         // Step 3: schedule tx for execution. At this point, there are no conflicts in all pending txs
+        index_transaction(pending_objects, tx);
         pending.push_back(std::move(tx));
         consider_commit();
     }
 
     void coalesce_transactions(const transaction_uptr& tx)
     {
-        while (true)
+        // Pending transactions never share objects, because they are merged when scheduled. Therefore, the
+        // pending transactions which are connected to tx are exactly those which contain one of its objects,
+        // and the objects added from them cannot pull in any further transactions.
+        std::unordered_set<transaction_t*> merged;
+        const size_t nr_objects = tx->get_objects().size();
+        for (size_t i = 0; i < nr_objects; i++)
         {
-            const size_t start_size = tx->get_objects().size();
-            for (auto& existing : pending)
+            auto it = pending_objects.find(tx->get_objects()[i].get());
+            if ((it == pending_objects.end()) || !merged.insert(it->second).second)
             {
-                if (transactions_intersect(existing, tx))
-                {
-                    for (auto& obj : existing->get_objects())
-                    {
-                        tx->add_object(obj);
-                    }
-                }
+                continue;
             }
 
-            if (start_size == tx->get_objects().size())
+            for (auto& obj : it->second->get_objects())
             {
-                // No new objects were added in the last iteration => done
-                break;
+                tx->add_object(obj);
             }
+
+            auto& scheduled = tx->get_trace().scheduled;
+            scheduled = std::min(scheduled, it->second->get_trace().scheduled);
         }
     }
 
     void remove_conflicts(const transaction_uptr& tx)
     {
+        std::unordered_set<transaction_t*> conflicts;
+        for (auto& obj : tx->get_objects())
+        {
+            auto it = pending_objects.find(obj.get());
+            if (it != pending_objects.end())
+            {
+                conflicts.insert(it->second);
+            }
+        }
+
+        if (conflicts.empty())
+        {
+            return;
+        }
+
         auto it = std::remove_if(pending.begin(), pending.end(), [&] (const transaction_uptr& existing)
         {
-            return transactions_intersect(existing, tx);
+            if (conflicts.count(existing.get()))
+            {
+                unindex_transaction(pending_objects, existing);
+                return true;
+            }
+
+            return false;
         });
         pending.erase(it, pending.end());
     }
@@ -83,6 +101,7 @@ struct wf::txn::transaction_manager_t::impl
             {
                 auto tx = std::move(pending[idx]);
                 pending.erase(pending.begin() + idx);
+                unindex_transaction(pending_objects, tx);
                 do_commit(std::move(tx));
                 // Note: the container may change after this operation, because some objects emit ready
                 // directly inside commit().
@@ -95,25 +114,67 @@ struct wf::txn::transaction_manager_t::impl
 
     bool can_commit_transaction(const transaction_uptr& tx)
     {
-        return std::none_of(committed.begin(), committed.end(), [&] (const transaction_uptr& comm)
+        const auto& objects = tx->get_objects();
+        return std::none_of(objects.begin(), objects.end(), [&] (const transaction_object_sptr& obj)
         {
-            return transactions_intersect(tx, comm);
+            return committed_objects.count(obj.get());
         });
     }
 
     void do_commit(transaction_uptr tx)
     {
         tx->connect(&on_tx_apply);
+        if (apply_scheduler)
+        {
+            tx->set_apply_scheduler(apply_scheduler);
+        }
+
+        index_transaction(committed_objects, tx);
         committed.push_back(std::move(tx));
         // Note: this might immediately trigger tx_apply if all objects are already ready!
         committed.back()->commit();
     }
 
+    /**
+     * An index from each object to the transaction which contains it. Since neither pending nor committed
+     * transactions share objects among themselves, an object is in at most one pending and at most one
+     * committed transaction, and conflicts can be found without comparing transactions pairwise.
+     */
+    using object_index_t = std::unordered_map<transaction_object_t*, transaction_t*>;
+
+    static void index_transaction(object_index_t& index, const transaction_uptr& tx)
+    {
+        for (auto& obj : tx->get_objects())
+        {
+            index[obj.get()] = tx.get();
+        }
+    }
+
+    static void unindex_transaction(object_index_t& index, const transaction_uptr& tx)
+    {
+        for (auto& obj : tx->get_objects())
+        {
+            auto it = index.find(obj.get());
+            if ((it != index.end()) && (it->second == tx.get()))
+            {
+                index.erase(it);
+            }
+        }
+    }
+
     std::vector<transaction_uptr> done; // Temporary storage for transactions which are complete
     std::vector<transaction_uptr> committed;
     std::vector<transaction_uptr> pending;
+    object_index_t committed_objects;
+    object_index_t pending_objects;
     wf::wl_idle_call idle_clear_done;
 
+    transaction_t::apply_scheduler_t apply_scheduler;
+
+    // The number of nested batches, and the transaction which collects the objects of the current batch.
+    int batch_depth = 0;
+    transaction_uptr batch;
+
     wf::signal::connection_t<transaction_applied_signal> on_tx_apply = [&] (transaction_applied_signal *ev)
     {
         // Move transactions which are done from committed to done.
@@ -123,6 +184,7 @@ struct wf::txn::transaction_manager_t::impl
             return existing.get() == ev->self;
         });
 
+        unindex_transaction(committed_objects, *it);
         done.push_back(std::move(*it));
         committed.erase(it);
         consider_commit();
@@ -16,9 +16,46 @@ void wf::txn::transaction_manager_t::schedule_transaction(wf::txn::transaction_u
     new_transaction_signal ev;
     ev.tx = tx.get();
     this->emit(&ev);
+
+    if (priv->batch_depth > 0)
+    {
+        if (!priv->batch)
+        {
+            priv->batch = std::move(tx);
+        } else
+        {
+            for (auto& obj : tx->get_objects())
+            {
+                priv->batch->add_object(obj);
+            }
+        }
+
+        return;
+    }
+
     priv->schedule_transaction(std::move(tx));
 }
 
+void wf::txn::transaction_manager_t::begin_batch()
+{
+    priv->batch_depth++;
+}
+
+void wf::txn::transaction_manager_t::end_batch()
+{
+    wf::dassert(priv->batch_depth > 0, "end_batch() without begin_batch()!");
+    priv->batch_depth--;
+    if ((priv->batch_depth == 0) && priv->batch)
+    {
+        priv->schedule_transaction(std::move(priv->batch));
+    }
+}
+
+void wf::txn::transaction_manager_t::set_apply_scheduler(transaction_t::apply_scheduler_t scheduler)
+{
+    priv->apply_scheduler = std::move(scheduler);
+}
+
 void wf::txn::transaction_manager_t::schedule_object(transaction_object_sptr object)
 {
     auto tx = wf::txn::transaction_t::create();
@@ -26,24 +63,12 @@ void wf::txn::transaction_manager_t::schedule_object(transaction_object_sptr obj
     schedule_transaction(std::move(tx));
 }
 
-template<class T>
-static bool is_contained(const std::vector<T>& objs, const T& object)
-{
-    return std::find(objs.begin(), objs.end(), object) != objs.end();
-}
-
 bool wf::txn::transaction_manager_t::is_object_pending(transaction_object_sptr object) const
 {
-    return std::any_of(this->priv->pending.begin(), this->priv->pending.end(), [&] (auto& pending)
-    {
-        return is_contained(pending->get_objects(), object);
-    });
+    return this->priv->pending_objects.count(object.get());
 }
 
 bool wf::txn::transaction_manager_t::is_object_committed(transaction_object_sptr object) const
 {
-    return std::any_of(this->priv->committed.begin(), this->priv->committed.end(), [&] (auto& committed)
-    {
-        return is_contained(committed->get_objects(), object);
-    });
+    return this->priv->committed_objects.count(object.get());
 }
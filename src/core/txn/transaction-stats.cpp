@@ -0,0 +1,126 @@
+#include "transaction-stats.hpp"
+#include "../demangle.hpp"
+#include <wayfire/txn/transaction-stats.hpp>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace
+{
+/** The number of timed out transactions which are remembered. */
+constexpr size_t MAX_RECENT_TIMEOUTS = 16;
+
+struct stats_storage_t
+{
+    wf::txn::transaction_stats_t totals;
+    /*
+     * Keyed by the demangled type name and not by the address of the type information, because a plugin
+     * which is reloaded may get the addresses of another plugin's types.
+     */
+    std::unordered_map<std::string, wf::txn::object_type_stats_t> object_types;
+    std::deque<wf::txn::timed_out_transaction_t> recent_timeouts;
+};
+
+stats_storage_t& get_storage()
+{
+    static stats_storage_t storage;
+    return storage;
+}
+
+int64_t to_us(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+}
+
+int64_t wf::txn::latency_histogram_t::get_bucket_limit_us(int bucket)
+{
+    // 1ms, 2ms, 4ms, ... 1024ms, and everything above
+    return (bucket < NR_BUCKETS - 1) ? (1000ll << bucket) : -1;
+}
+
+void wf::txn::latency_histogram_t::add(int64_t latency_us)
+{
+    int bucket = 0;
+    while ((bucket < NR_BUCKETS - 1) && (latency_us >= get_bucket_limit_us(bucket)))
+    {
+        ++bucket;
+    }
+
+    buckets[bucket]++;
+    count++;
+    total_us += latency_us;
+    max_us    = std::max(max_us, latency_us);
+}
+
+void wf::txn::record_transaction_stats(transaction_t& tx, bool timed_out)
+{
+    auto& storage = get_storage();
+    auto& trace   = tx.get_trace();
+
+    storage.totals.applied++;
+    if (trace.scheduled != transaction_trace_t::time_point_t{})
+    {
+        storage.totals.schedule_to_commit.add(to_us(trace.committed - trace.scheduled));
+    }
+
+    storage.totals.commit_to_apply.add(to_us(trace.applied - trace.committed));
+
+    timed_out_transaction_t timeout_info;
+    for (auto& obj : tx.get_objects())
+    {
+        auto type_name   = demangle_type_name(typeid(*obj).name());
+        auto& type_stats = storage.object_types[type_name];
+        if (type_stats.type.empty())
+        {
+            type_stats.type = std::move(type_name);
+        }
+
+        auto it = trace.ready.find(obj.get());
+        if (it != trace.ready.end())
+        {
+            type_stats.ready_latency.add(to_us(it->second - trace.committed));
+        } else
+        {
+            type_stats.ready_latency.add(to_us(trace.applied - trace.committed));
+            type_stats.timeouts++;
+            timeout_info.late_objects.push_back(obj->stringify());
+        }
+    }
+
+    if (timed_out)
+    {
+        storage.totals.timed_out++;
+        timeout_info.duration_us = to_us(trace.applied - trace.committed);
+        storage.recent_timeouts.push_back(std::move(timeout_info));
+        if (storage.recent_timeouts.size() > MAX_RECENT_TIMEOUTS)
+        {
+            storage.recent_timeouts.pop_front();
+        }
+    }
+}
+
+wf::txn::transaction_stats_t wf::txn::get_transaction_stats()
+{
+    auto& storage = get_storage();
+    transaction_stats_t stats = storage.totals;
+    for (auto& [_, type_stats] : storage.object_types)
+    {
+        stats.object_types.push_back(type_stats);
+    }
+
+    std::sort(stats.object_types.begin(), stats.object_types.end(), [] (const auto& a, const auto& b)
+    {
+        return a.ready_latency.max_us > b.ready_latency.max_us;
+    });
+
+    stats.recent_timeouts.assign(storage.recent_timeouts.begin(), storage.recent_timeouts.end());
+    return stats;
+}
+
+void wf::txn::reset_transaction_stats()
+{
+    get_storage() = {};
+}
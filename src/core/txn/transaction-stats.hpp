@@ -0,0 +1,14 @@
+#pragma once
+
+#include <wayfire/txn/transaction.hpp>
+
+namespace wf
+{
+namespace txn
+{
+/**
+ * Add the trace of a transaction which is being applied to the statistics.
+ */
+void record_transaction_stats(transaction_t& tx, bool timed_out);
+}
+}
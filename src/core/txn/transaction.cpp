@@ -3,6 +3,7 @@
 #include <wayfire/txn/transaction.hpp>
 #include <sstream>
 #include <wayfire/debug.hpp>
+#include "transaction-stats.hpp"
 
 std::string wf::txn::transaction_object_t::stringify() const
 {
@@ -18,6 +19,7 @@ wf::txn::transaction_t::transaction_t(uint64_t timeout, timer_setter_t timer_set
 
     this->on_object_ready = [=] (object_ready_signal *ev)
     {
+        trace.ready[ev->self] = std::chrono::steady_clock::now();
         this->count_ready_objects++;
         LOGC(TXNI, "Transaction ", this, " object ", ev->self->stringify(), " became ready (",
             count_ready_objects, "/", this->objects.size(), ")");
@@ -25,11 +27,40 @@ wf::txn::transaction_t::transaction_t(uint64_t timeout, timer_setter_t timer_set
         wf::dassert(count_ready_objects <= (int)this->objects.size(), "object emitted ready multiple times?");
         if (count_ready_objects == (int)this->objects.size())
         {
-            apply(false);
+            request_apply();
         }
     };
 }
 
+void wf::txn::transaction_t::set_apply_scheduler(apply_scheduler_t scheduler)
+{
+    this->apply_scheduler = std::move(scheduler);
+}
+
+void wf::txn::transaction_t::request_apply()
+{
+    if (!apply_scheduler)
+    {
+        apply(false);
+        return;
+    }
+
+    if (apply_scheduled)
+    {
+        return;
+    }
+
+    apply_scheduled = true;
+    std::weak_ptr<bool> alive = alive_token;
+    apply_scheduler(this, [this, alive] ()
+    {
+        if (!alive.expired())
+        {
+            apply(false);
+        }
+    });
+}
+
 const std::vector<wf::txn::transaction_object_sptr>& wf::txn::transaction_t::get_objects() const
 {
     return this->objects;
@@ -37,17 +68,22 @@ const std::vector<wf::txn::transaction_object_sptr>& wf::txn::transaction_t::get
 
 void wf::txn::transaction_t::add_object(transaction_object_sptr object)
 {
-    auto it = std::find(objects.begin(), objects.end(), object);
-    if (it == objects.end())
+    if (object_set.insert(object.get()).second)
     {
         LOGC(TXNI, "Transaction ", this, " add object ", object->stringify());
         objects.push_back(object);
     }
 }
 
+wf::txn::transaction_trace_t& wf::txn::transaction_t::get_trace()
+{
+    return trace;
+}
+
 void wf::txn::transaction_t::commit()
 {
     LOGC(TXN, "Committing transaction ", this, " with timeout ", this->timeout);
+    trace.committed = std::chrono::steady_clock::now();
     for (auto& obj : this->objects)
     {
         obj->connect(&on_object_ready);
@@ -63,6 +99,13 @@ void wf::txn::transaction_t::commit()
 
 void wf::txn::transaction_t::apply(bool did_timeout)
 {
+    if (applied)
+    {
+        // The timeout fired after a deferred apply, or the deferred apply came after the timeout.
+        return;
+    }
+
+    applied = true;
     on_object_ready.disconnect();
 
     LOGC(TXN, "Applying transaction ", this, " timed_out: ", did_timeout);
@@ -71,6 +114,9 @@ void wf::txn::transaction_t::apply(bool did_timeout)
         obj->apply();
     }
 
+    trace.applied = std::chrono::steady_clock::now();
+    record_transaction_stats(*this, did_timeout);
+
     transaction_applied_signal ev;
     ev.self = this;
     ev.timed_out = did_timeout;
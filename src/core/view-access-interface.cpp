@@ -8,7 +8,9 @@
 #include <wayfire/nonstd/wlroots-full.hpp>
 #include <algorithm>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <wlr/util/edges.h>
 
 namespace wf
@@ -22,6 +24,101 @@ view_access_interface_t::view_access_interface_t(wayfire_view view) : _view(view
 view_access_interface_t::~view_access_interface_t()
 {}
 
+namespace
+{
+enum class view_attribute_t
+{
+    APP_ID,
+    TITLE,
+    ROLE,
+    FULLSCREEN,
+    ACTIVATED,
+    MINIMIZED,
+    FOCUSABLE,
+    MAPPED,
+    TILED_LEFT,
+    TILED_RIGHT,
+    TILED_TOP,
+    TILED_BOTTOM,
+    MAXIMIZED,
+    FLOATING,
+    TYPE,
+};
+
+/**
+ * Look up the attribute by its name with a single hash lookup, instead of comparing the name to each of the
+ * supported attributes in turn.
+ */
+std::optional<view_attribute_t> find_attribute(const std::string& identifier)
+{
+    static const std::unordered_map<std::string, view_attribute_t> attributes = {
+        {"app_id", view_attribute_t::APP_ID},
+        {"title", view_attribute_t::TITLE},
+        {"role", view_attribute_t::ROLE},
+        {"fullscreen", view_attribute_t::FULLSCREEN},
+        {"activated", view_attribute_t::ACTIVATED},
+        {"minimized", view_attribute_t::MINIMIZED},
+        {"focusable", view_attribute_t::FOCUSABLE},
+        {"mapped", view_attribute_t::MAPPED},
+        {"tiled-left", view_attribute_t::TILED_LEFT},
+        {"tiled-right", view_attribute_t::TILED_RIGHT},
+        {"tiled-top", view_attribute_t::TILED_TOP},
+        {"tiled-bottom", view_attribute_t::TILED_BOTTOM},
+        {"maximized", view_attribute_t::MAXIMIZED},
+        {"floating", view_attribute_t::FLOATING},
+        {"type", view_attribute_t::TYPE},
+    };
+
+    auto it = attributes.find(identifier);
+    if (it == attributes.end())
+    {
+        return {};
+    }
+
+    return it->second;
+}
+
+std::string get_view_type(wayfire_view view)
+{
+    if (view->role == VIEW_ROLE_TOPLEVEL)
+    {
+        return "toplevel";
+    }
+
+    if (view->role == VIEW_ROLE_UNMANAGED)
+    {
+#if WF_HAS_XWAYLAND
+        auto surf = view->get_wlr_surface();
+        if (surf && wlr_xwayland_surface_try_from_wlr_surface(surf))
+        {
+            return "x-or";
+        }
+
+#endif
+        return "unmanaged";
+    }
+
+    if (!view->get_output())
+    {
+        return "unknown";
+    }
+
+    auto layer = get_view_layer(view);
+    if ((layer == wf::scene::layer::BACKGROUND) || (layer == wf::scene::layer::BOTTOM))
+    {
+        return "background";
+    } else if (layer == wf::scene::layer::TOP)
+    {
+        return "panel";
+    } else if (layer == wf::scene::layer::OVERLAY)
+    {
+        return "overlay";
+    }
+
+    return "";
+}
+}
+
 variant_t view_access_interface_t::get(const std::string & identifier, bool & error)
 {
     variant_t out = std::string(""); // Default to empty string as output.
@@ -35,15 +132,42 @@ variant_t view_access_interface_t::get(const std::string & identifier, bool & er
         return out;
     }
 
-    uint32_t view_tiled_edges = toplevel_cast(_view) ? toplevel_cast(_view)->pending_tiled_edges() : 0;
-    if (identifier == "app_id")
+    auto attribute = find_attribute(identifier);
+    if (!attribute)
     {
-        out = _view->get_app_id();
-    } else if (identifier == "title")
+        std::cerr << "View access interface: Get operation triggered to" <<
+            " unsupported view property " << identifier << std::endl;
+
+        return out;
+    }
+
+    auto toplevel = toplevel_cast(_view);
+    auto tiled_edges = [&] () -> uint32_t
     {
-        out = _view->get_title();
-    } else if (identifier == "role")
+        return toplevel ? toplevel->pending_tiled_edges() : 0;
+    };
+
+    switch (*attribute)
     {
+      case view_attribute_t::APP_ID:
+        if (!_cached_strings.app_id)
+        {
+            _cached_strings.app_id = _view->get_app_id();
+        }
+
+        out = *_cached_strings.app_id;
+        break;
+
+      case view_attribute_t::TITLE:
+        if (!_cached_strings.title)
+        {
+            _cached_strings.title = _view->get_title();
+        }
+
+        out = *_cached_strings.title;
+        break;
+
+      case view_attribute_t::ROLE:
         switch (_view->role)
         {
           case VIEW_ROLE_TOPLEVEL:
@@ -65,89 +189,61 @@ variant_t view_access_interface_t::get(const std::string & identifier, bool & er
             error = true;
             break;
         }
-    } else if (identifier == "fullscreen")
-    {
-        out = toplevel_cast(_view) ? toplevel_cast(_view)->pending_fullscreen() : false;
-    } else if (identifier == "activated")
-    {
-        out = toplevel_cast(_view) ? toplevel_cast(_view)->activated : false;
-    } else if (identifier == "minimized")
-    {
-        out = toplevel_cast(_view) ? toplevel_cast(_view)->minimized : false;
-    } else if (identifier == "focusable")
-    {
+
+        break;
+
+      case view_attribute_t::FULLSCREEN:
+        out = toplevel ? toplevel->pending_fullscreen() : false;
+        break;
+
+      case view_attribute_t::ACTIVATED:
+        out = toplevel ? toplevel->activated : false;
+        break;
+
+      case view_attribute_t::MINIMIZED:
+        out = toplevel ? toplevel->minimized : false;
+        break;
+
+      case view_attribute_t::FOCUSABLE:
         out = _view->is_focusable();
-    } else if (identifier == "mapped")
-    {
+        break;
+
+      case view_attribute_t::MAPPED:
         out = _view->is_mapped();
-    } else if (identifier == "tiled-left")
-    {
-        out = ((view_tiled_edges & WLR_EDGE_LEFT) > 0);
-    } else if (identifier == "tiled-right")
-    {
-        out = ((view_tiled_edges & WLR_EDGE_RIGHT) > 0);
-    } else if (identifier == "tiled-top")
-    {
-        out = ((view_tiled_edges & WLR_EDGE_TOP) > 0);
-    } else if (identifier == "tiled-bottom")
-    {
-        out = ((view_tiled_edges & WLR_EDGE_BOTTOM) > 0);
-    } else if (identifier == "maximized")
-    {
-        out = (view_tiled_edges == TILED_EDGES_ALL);
-    } else if (identifier == "floating")
-    {
-        out = toplevel_cast(_view) ? (toplevel_cast(_view)->pending_tiled_edges() == 0) : false;
-    } else if (identifier == "type")
-    {
-        do {
-            if (_view->role == VIEW_ROLE_TOPLEVEL)
-            {
-                out = std::string("toplevel");
-                break;
-            }
-
-            if (_view->role == VIEW_ROLE_UNMANAGED)
-            {
-#if WF_HAS_XWAYLAND
-                auto surf = _view->get_wlr_surface();
-                if (surf && wlr_xwayland_surface_try_from_wlr_surface(surf))
-                {
-                    out = std::string("x-or");
-                    break;
-                }
+        break;
 
-#endif
-                out = std::string("unmanaged");
-                break;
-            }
-
-            if (!_view->get_output())
-            {
-                out = std::string("unknown");
-                break;
-            }
-
-            auto layer = get_view_layer(_view);
-            if ((layer == wf::scene::layer::BACKGROUND) || (layer == wf::scene::layer::BOTTOM))
-            {
-                out = std::string("background");
-            } else if (layer == wf::scene::layer::TOP)
-            {
-                out = std::string("panel");
-            } else if (layer == wf::scene::layer::OVERLAY)
-            {
-                out = std::string("overlay");
-            }
+      case view_attribute_t::TILED_LEFT:
+        out = ((tiled_edges() & WLR_EDGE_LEFT) > 0);
+        break;
 
-            break;
+      case view_attribute_t::TILED_RIGHT:
+        out = ((tiled_edges() & WLR_EDGE_RIGHT) > 0);
+        break;
 
-            out = std::string("unknown");
-        } while (false);
-    } else
-    {
-        std::cerr << "View access interface: Get operation triggered to" <<
-            " unsupported view property " << identifier << std::endl;
+      case view_attribute_t::TILED_TOP:
+        out = ((tiled_edges() & WLR_EDGE_TOP) > 0);
+        break;
+
+      case view_attribute_t::TILED_BOTTOM:
+        out = ((tiled_edges() & WLR_EDGE_BOTTOM) > 0);
+        break;
+
+      case view_attribute_t::MAXIMIZED:
+        out = (tiled_edges() == TILED_EDGES_ALL);
+        break;
+
+      case view_attribute_t::FLOATING:
+        out = toplevel ? (toplevel->pending_tiled_edges() == 0) : false;
+        break;
+
+      case view_attribute_t::TYPE:
+        if (!_cached_strings.type)
+        {
+            _cached_strings.type = get_view_type(_view);
+        }
+
+        out = *_cached_strings.type;
+        break;
     }
 
     return out;
@@ -156,5 +252,6 @@ variant_t view_access_interface_t::get(const std::string & identifier, bool & er
 void view_access_interface_t::set_view(wayfire_view view)
 {
     _view = view;
+    _cached_strings = {};
 }
 } // End namespace wf.
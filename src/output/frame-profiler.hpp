@@ -0,0 +1,336 @@
+#pragma once
+
+#include <wayfire/render-manager.hpp>
+#include <wayfire/option-wrapper.hpp>
+#include <wayfire/opengl.hpp>
+#include <wayfire/util/log.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+/* From GL_EXT_disjoint_timer_query */
+#ifndef GL_TIME_ELAPSED_EXT
+    #define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+    #define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+namespace wf
+{
+/**
+ * A fixed-size ring buffer with a single writer (the repaint loop of an output) which can be read without
+ * taking any locks. Readers take a snapshot of the newest entries and drop those which were overwritten while
+ * the snapshot was being taken.
+ */
+template<class T, size_t N>
+class frame_ring_buffer_t
+{
+  public:
+    /** Append a new entry, possibly overwriting the oldest one. */
+    void push(const T& value)
+    {
+        const uint64_t seq = head.load(std::memory_order_relaxed);
+        slots[seq % N] = value;
+        head.store(seq + 1, std::memory_order_release);
+    }
+
+    /**
+     * @return The entry with the given sequence number, or nullptr if it is not in the buffer anymore.
+     * Only the writer may use this function.
+     */
+    T *find(uint64_t seq)
+    {
+        const uint64_t current = head.load(std::memory_order_relaxed);
+        if ((seq >= current) || (current - seq > N))
+        {
+            return nullptr;
+        }
+
+        return &slots[seq % N];
+    }
+
+    /**
+     * @return Up to @max_entries of the newest entries in the buffer, ordered from oldest to newest.
+     */
+    std::vector<T> snapshot(size_t max_entries) const
+    {
+        const uint64_t end   = head.load(std::memory_order_acquire);
+        const uint64_t count = std::min<uint64_t>({end, N, max_entries});
+
+        std::vector<T> result;
+        result.reserve(count);
+        for (uint64_t seq = end - count; seq < end; seq++)
+        {
+            result.push_back(slots[seq % N]);
+        }
+
+        // Drop entries which the writer overwrote in the meantime.
+        const uint64_t new_end = head.load(std::memory_order_acquire);
+        const uint64_t lost    = std::min<uint64_t>(new_end - end, result.size());
+        result.erase(result.begin(), result.begin() + lost);
+        return result;
+    }
+
+  private:
+    std::array<T, N> slots;
+    std::atomic<uint64_t> head{0};
+};
+
+/**
+ * The frame profiler records how long each stage of an output repaint takes.
+ *
+ * The CPU time of each stage is measured with a monotonic clock. If the GL driver supports
+ * GL_EXT_disjoint_timer_query, the GPU time of the whole frame is measured with timer queries as well.
+ * Since query results become available asynchronously, the GPU time of a frame is filled in during one of
+ * the following frames.
+ *
+ * Profiling is enabled with the core/frame_profiling option, otherwise all methods are no-ops. The GPU time
+ * can still be measured for the callback set with set_gpu_time_callback() though.
+ */
+class frame_profiler_t
+{
+  public:
+    static constexpr size_t MAX_FRAMES = 256;
+
+    frame_profiler_t() = default;
+    ~frame_profiler_t()
+    {
+        if (gpu_queries.empty())
+        {
+            return;
+        }
+
+        OpenGL::render_begin();
+        for (auto& q : gpu_queries)
+        {
+            GL_CALL(glDeleteQueries(1, &q.id));
+        }
+
+        OpenGL::render_end();
+    }
+
+    frame_profiler_t(const frame_profiler_t&) = delete;
+    frame_profiler_t(frame_profiler_t&&) = delete;
+    frame_profiler_t& operator =(const frame_profiler_t&) = delete;
+    frame_profiler_t& operator =(frame_profiler_t&&) = delete;
+
+    /**
+     * Set a callback which is called with the GPU time of each measured frame, in nanoseconds, once it is
+     * known.
+     */
+    void set_gpu_time_callback(std::function<void(int64_t)> callback)
+    {
+        this->gpu_time_callback = std::move(callback);
+    }
+
+    /**
+     * Start profiling a new frame.
+     *
+     * @param measure_gpu Whether to measure the GPU time of the frame for the GPU time callback, even if
+     *   profiling is disabled.
+     */
+    void begin_frame(bool measure_gpu = false)
+    {
+        in_frame     = enabled;
+        gpu_in_frame = in_frame || (measure_gpu && gpu_time_callback);
+        if (!in_frame)
+        {
+            return;
+        }
+
+        current = {};
+        std::fill(std::begin(current.stage_ns), std::end(current.stage_ns), -1);
+        current.start_ns = now();
+        last_mark = current.start_ns;
+    }
+
+    /** Record the time spent since the previous mark as the duration of @stage. */
+    void mark(frame_profile_stage_t stage)
+    {
+        if (!in_frame)
+        {
+            return;
+        }
+
+        const int64_t t = now();
+        current.stage_ns[stage] = t - last_mark;
+        last_mark = t;
+    }
+
+    /** The frame did not result in any output commit, do not record it. */
+    void cancel_frame()
+    {
+        in_frame     = false;
+        gpu_in_frame = false;
+    }
+
+    /** Finish the current frame and store its timings in the ring buffer. */
+    void end_frame(bool direct_scanout)
+    {
+        gpu_in_frame = false;
+        if (!in_frame)
+        {
+            // The GPU time is still reported to the callback, but there is no frame to attach it to.
+            pending_gpu_query = nullptr;
+            return;
+        }
+
+        in_frame = false;
+        current.sequence = next_sequence++;
+        current.direct_scanout = direct_scanout;
+        if (pending_gpu_query)
+        {
+            pending_gpu_query->frame = current.sequence;
+            pending_gpu_query = nullptr;
+        }
+
+        frames.push(current);
+    }
+
+    /**
+     * Start measuring GPU time. Must be called with the output's GL context current.
+     */
+    void begin_gpu_timer()
+    {
+        if (!gpu_in_frame || !init_gpu_timers())
+        {
+            return;
+        }
+
+        collect_gpu_results();
+        for (auto& q : gpu_queries)
+        {
+            if (!q.in_use)
+            {
+                GL_CALL(glBeginQuery(GL_TIME_ELAPSED_EXT, q.id));
+                q.in_use = true;
+                q.frame  = -1;
+                pending_gpu_query = &q;
+                return;
+            }
+        }
+    }
+
+    /** Stop measuring GPU time for the current frame. */
+    void end_gpu_timer()
+    {
+        if (pending_gpu_query)
+        {
+            GL_CALL(glEndQuery(GL_TIME_ELAPSED_EXT));
+        }
+    }
+
+    /** @return Up to @max_frames of the most recently profiled frames, oldest first. */
+    std::vector<frame_timings_t> get_frames(size_t max_frames) const
+    {
+        return frames.snapshot(max_frames);
+    }
+
+  private:
+    wf::option_wrapper_t<bool> enabled{"core/frame_profiling"};
+    bool in_frame = false;
+    bool gpu_in_frame = false;
+    std::function<void(int64_t)> gpu_time_callback;
+    int64_t last_mark = 0;
+    uint64_t next_sequence = 0;
+    frame_timings_t current;
+    frame_ring_buffer_t<frame_timings_t, MAX_FRAMES> frames;
+
+    static constexpr size_t MAX_GPU_QUERIES = 4;
+    struct gpu_query_t
+    {
+        GLuint id = 0;
+        bool in_use = false;
+        int64_t frame = -1;
+    };
+
+    enum class gpu_timer_support
+    {
+        UNKNOWN,
+        SUPPORTED,
+        UNSUPPORTED,
+    };
+
+    gpu_timer_support gpu_support = gpu_timer_support::UNKNOWN;
+    std::vector<gpu_query_t> gpu_queries;
+    gpu_query_t *pending_gpu_query = nullptr;
+
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool init_gpu_timers()
+    {
+        if (gpu_support != gpu_timer_support::UNKNOWN)
+        {
+            return gpu_support == gpu_timer_support::SUPPORTED;
+        }
+
+        auto extensions = (const char*)glGetString(GL_EXTENSIONS);
+        if (!extensions || !strstr(extensions, "GL_EXT_disjoint_timer_query"))
+        {
+            LOGI("GL_EXT_disjoint_timer_query is not supported, frame profiler will not measure GPU time.");
+            gpu_support = gpu_timer_support::UNSUPPORTED;
+            return false;
+        }
+
+        gpu_queries.resize(MAX_GPU_QUERIES);
+        for (auto& q : gpu_queries)
+        {
+            GL_CALL(glGenQueries(1, &q.id));
+        }
+
+        gpu_support = gpu_timer_support::SUPPORTED;
+        return true;
+    }
+
+    /** Read back the results of finished queries and attach them to their frames. */
+    void collect_gpu_results()
+    {
+        GLint disjoint = 0;
+        GL_CALL(glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint));
+
+        for (auto& q : gpu_queries)
+        {
+            if (!q.in_use)
+            {
+                continue;
+            }
+
+            GLuint available = 0;
+            GL_CALL(glGetQueryObjectuiv(q.id, GL_QUERY_RESULT_AVAILABLE, &available));
+            if (!available)
+            {
+                continue;
+            }
+
+            GLuint elapsed = 0;
+            GL_CALL(glGetQueryObjectuiv(q.id, GL_QUERY_RESULT, &elapsed));
+            q.in_use = false;
+
+            // A disjoint event (e.g. GPU reset or frequency change) invalidates all measurements in flight
+            if (disjoint)
+            {
+                continue;
+            }
+
+            if (auto frame = (q.frame >= 0) ? frames.find(q.frame) : nullptr)
+            {
+                frame->gpu_ns = elapsed;
+            }
+
+            if (gpu_time_callback)
+            {
+                gpu_time_callback(elapsed);
+            }
+        }
+    }
+};
+}
@@ -0,0 +1,109 @@
+#include "plane-assignment.hpp"
+#include <algorithm>
+
+bool wf::plane_assignment_t::is_on_overlay(const scene::render_instance_t *instance) const
+{
+    return std::any_of(overlays.begin(), overlays.end(), [&] (const scene::plane_candidate_t& c)
+    {
+        return c.instance == instance;
+    });
+}
+
+static bool contains(const wf::geometry_t& outer, const wf::geometry_t& inner)
+{
+    return (inner.x >= outer.x) && (inner.y >= outer.y) &&
+           (inner.x + inner.width <= outer.x + outer.width) &&
+           (inner.y + inner.height <= outer.y + outer.height);
+}
+
+/**
+ * Assign planes with at most @max_overlays overlays, without testing the result.
+ */
+static wf::plane_assignment_t try_assign(const std::vector<wf::scene::plane_candidate_t>& candidates,
+    wf::geometry_t output_box, bool allow_primary, size_t max_overlays)
+{
+    wf::plane_assignment_t result;
+
+    // Visible content which needs to be composited, front to back
+    std::vector<const wf::scene::plane_candidate_t*> composited;
+    wf::region_t composited_region;
+    wf::region_t opaque_region;
+
+    for (auto& candidate : candidates)
+    {
+        auto visible = (wf::region_t{candidate.geometry} & output_box) ^ opaque_region;
+        if (visible.empty())
+        {
+            continue;
+        }
+
+        const bool can_overlay = candidate.buffer && contains(output_box, candidate.geometry) &&
+            (result.overlays.size() < max_overlays) &&
+            (composited_region & candidate.geometry).empty();
+        if (can_overlay)
+        {
+            result.overlays.push_back(candidate);
+        } else
+        {
+            composited.push_back(&candidate);
+            composited_region |= visible;
+        }
+
+        if (candidate.opaque)
+        {
+            opaque_region |= candidate.geometry;
+        }
+    }
+
+    // Overlays were collected front to back, but planes are ordered bottom to top.
+    std::reverse(result.overlays.begin(), result.overlays.end());
+
+    auto fits_primary = [&] (const wf::scene::plane_candidate_t& candidate)
+    {
+        return candidate.buffer && candidate.opaque && (candidate.geometry == output_box);
+    };
+
+    if (!allow_primary)
+    {
+        return result;
+    }
+
+    if ((composited.size() == 1) && fits_primary(*composited.front()))
+    {
+        result.primary = *composited.front();
+    } else if (composited.empty() && !result.overlays.empty() && fits_primary(result.overlays.front()))
+    {
+        // Nothing is composited and the bottom overlay covers the output, it might as well be the primary.
+        result.primary = result.overlays.front();
+        result.overlays.erase(result.overlays.begin());
+    }
+
+    return result;
+}
+
+wf::plane_assignment_t wf::assign_planes(const std::vector<scene::plane_candidate_t>& candidates,
+    wf::geometry_t output_box, bool allow_primary, plane_backend_t& backend)
+{
+    for (int max_overlays = backend.get_max_overlays(); max_overlays >= 0; max_overlays--)
+    {
+        auto assignment = try_assign(candidates, output_box, allow_primary, max_overlays);
+        if (!assignment.uses_planes())
+        {
+            // Fewer overlays will not make the primary plane usable either.
+            return {};
+        }
+
+        if ((int)assignment.overlays.size() < max_overlays)
+        {
+            // Not enough candidates to use all planes, the next iteration would have the same result.
+            max_overlays = assignment.overlays.size();
+        }
+
+        if (backend.test_assignment(assignment))
+        {
+            return assignment;
+        }
+    }
+
+    return {};
+}
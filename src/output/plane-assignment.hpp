@@ -0,0 +1,69 @@
+#pragma once
+
+#include <wayfire/scene-render.hpp>
+#include <optional>
+#include <vector>
+
+namespace wf
+{
+/**
+ * The result of assigning the content of an output to hardware planes.
+ */
+struct plane_assignment_t
+{
+    /**
+     * The candidate shown on the primary plane. If set, the output does not need to be composited at all.
+     * Otherwise, the primary plane shows the composited content, without the candidates on overlay planes.
+     */
+    std::optional<scene::plane_candidate_t> primary;
+
+    /** The candidates shown on overlay planes, ordered from bottom to top. */
+    std::vector<scene::plane_candidate_t> overlays;
+
+    /** @return true if anything was assigned to a plane. */
+    bool uses_planes() const
+    {
+        return primary.has_value() || !overlays.empty();
+    }
+
+    /** @return true if the render instance of the candidate is shown on an overlay plane. */
+    bool is_on_overlay(const scene::render_instance_t *instance) const;
+};
+
+/**
+ * The interface between the plane assignment logic and the hardware (typically DRM planes exposed as wlroots
+ * output layers).
+ */
+class plane_backend_t
+{
+  public:
+    virtual ~plane_backend_t() = default;
+
+    /** @return The number of overlay planes which may be used at most. */
+    virtual size_t get_max_overlays() const = 0;
+
+    /**
+     * Check whether the hardware can display the given assignment.
+     * This should not change what is currently shown on the output.
+     */
+    virtual bool test_assignment(const plane_assignment_t& assignment) = 0;
+};
+
+/**
+ * Decide which candidates to show on planes.
+ *
+ * Candidates are walked front to back. A candidate with a buffer is put on an overlay plane if no composited
+ * content above it overlaps it, and if everything else ends up being a single opaque buffer covering the
+ * whole output, that buffer is put on the primary plane and composition is skipped entirely. Content hidden
+ * behind opaque candidates is ignored.
+ *
+ * If the backend rejects an assignment, fewer overlays are tried, down to no planes at all.
+ *
+ * @param candidates The content of the output, front to back, see render_instance_t::collect_plane_candidates.
+ * @param output_box The output-local geometry of the output.
+ * @param allow_primary Whether a buffer may be put on the primary plane.
+ * @param backend The backend used to test assignments.
+ */
+plane_assignment_t assign_planes(const std::vector<scene::plane_candidate_t>& candidates,
+    wf::geometry_t output_box, bool allow_primary, plane_backend_t& backend);
+}
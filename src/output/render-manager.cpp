@@ -13,7 +13,12 @@
 #include "../core/opengl-priv.hpp"
 #include "../main.hpp"
 #include "wayfire/workspace-set.hpp"
+#include "frame-profiler.hpp"
+#include "render-pass-arena.hpp"
+#include "plane-assignment.hpp"
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/nonstd/safe-list.hpp>
 #include <wayfire/util/log.hpp>
@@ -30,6 +35,7 @@ struct swapchain_damage_manager_t
 {
     signal::connection_t<scene::root_node_update_signal> root_update;
     std::vector<scene::render_instance_uptr> render_instances;
+    scene::incremental_instances_t instances_regen;
 
     wf::wl_listener_wrapper on_needs_frame;
     wf::wl_listener_wrapper on_damage;
@@ -44,6 +50,9 @@ struct swapchain_damage_manager_t
     bool pending_gamma_lut = false;
     wf::wl_idle_call idle_recompute_visibility;
 
+    wf::option_wrapper_t<int> damage_max_rects{"core/damage_max_rects"};
+    wf::option_wrapper_t<double> damage_max_overhead{"core/damage_max_overhead"};
+
     void update_scenegraph(uint32_t update_mask)
     {
         if (update_mask & scene::update_flag::MASKED)
@@ -67,8 +76,8 @@ struct swapchain_damage_manager_t
                 this->damage(region, true);
             };
 
-            render_instances.clear();
-            root->gen_render_instances(render_instances, push_damage, wo);
+            // Layers and outputs which did not change keep their instances.
+            instances_regen.regen_node(render_instances, root.get(), push_damage, wo);
         }
 
         if (update_mask & recompute_visibility_on)
@@ -167,6 +176,9 @@ struct swapchain_damage_manager_t
             return;
         }
 
+        output_damage_signal data{region};
+        wo->emit(&data);
+
         /* Wlroots expects damage after scaling */
         auto scaled_region = region * wo->handle->scale;
         frame_damage |= scaled_region;
@@ -184,6 +196,10 @@ struct swapchain_damage_manager_t
             return;
         }
 
+        wf::region_t region{box};
+        output_damage_signal data{region};
+        wo->emit(&data);
+
         /* Wlroots expects damage after scaling */
         auto scaled_box = box * wo->handle->scale;
         frame_damage |= scaled_box;
@@ -376,6 +392,11 @@ struct swapchain_damage_manager_t
         {
             frame_damage |= get_wlr_damage_box();
         }
+
+        wf::region_simplify_policy_t policy;
+        policy.max_rects         = damage_max_rects;
+        policy.max_area_overhead = damage_max_overhead;
+        frame_damage.simplify(policy);
     }
 
     /**
@@ -794,6 +815,16 @@ class depth_buffer_manager_t
  * delay is increased by one. If the next frame is delayed, then
  * `increase_window` is doubled, otherwise, it is halved
  * (but it must stay between `MIN_INCREASE_WINDOW` and `MAX_INCREASE_WINDOW`).
+ *
+ * If core/max_render_time_auto is enabled, the delay is instead predicted from
+ * the measured paint durations: Wayfire keeps the last `AUTO_SAMPLES` paint
+ * durations of the output and starts painting just early enough that a paint
+ * taking as long as the `AUTO_PERCENTILE`-th percentile of them (plus a safety
+ * margin) still makes it to the next vblank. Each missed frame widens the safety
+ * margin, which then slowly shrinks again while frames are on time.
+ *
+ * The duration of a paint is the CPU time of the paint plus, if the GPU time can
+ * be measured with timer queries, the GPU time of the most recently measured frame.
  */
 struct repaint_delay_manager_t
 {
@@ -807,6 +838,32 @@ struct repaint_delay_manager_t
         on_present.connect(&output->handle->events.present);
     }
 
+    /**
+     * @return Whether the GPU time of frames should be measured and reported with report_gpu_duration().
+     */
+    bool needs_gpu_duration()
+    {
+        return max_render_time_auto;
+    }
+
+    /**
+     * Report how long the GPU took to render a recent frame, in microseconds.
+     */
+    void report_gpu_duration(int64_t duration_usec)
+    {
+        last_gpu_usec = duration_usec;
+    }
+
+    /**
+     * Report how long the last paint of the output took on the CPU, in microseconds.
+     */
+    void report_paint_duration(int64_t duration_usec)
+    {
+        paint_samples[next_sample] = duration_usec + last_gpu_usec;
+        next_sample = (next_sample + 1) % AUTO_SAMPLES;
+        nr_samples  = std::min(nr_samples + 1, AUTO_SAMPLES);
+    }
+
     /**
      * The next frame will be skipped.
      */
@@ -831,7 +888,10 @@ struct repaint_delay_manager_t
         const int64_t refresh = this->refresh_nsec / 1e6;
         const int64_t on_time_thresh = refresh * 1.5;
         const int64_t last_frame_len = get_current_time() - last_pageflip;
-        if (last_frame_len <= on_time_thresh)
+        if (max_render_time_auto)
+        {
+            update_auto_delay(last_frame_len > on_time_thresh);
+        } else if (last_frame_len <= on_time_thresh)
         {
             // We rendered last frame on time
             if (get_current_time() - last_increase >= increase_window)
@@ -906,6 +966,33 @@ struct repaint_delay_manager_t
         last_increase = get_current_time();
     }
 
+    void update_auto_delay(bool missed_frame)
+    {
+        if (missed_frame)
+        {
+            safety_margin_usec = std::min(safety_margin_usec * 2, AUTO_MAX_MARGIN_USEC);
+        } else
+        {
+            safety_margin_usec = std::max(safety_margin_usec - AUTO_MARGIN_DECAY_USEC, AUTO_MIN_MARGIN_USEC);
+        }
+
+        const int64_t refresh_usec = this->refresh_nsec / 1000;
+        if ((refresh_usec <= 0) || (nr_samples < AUTO_MIN_SAMPLES))
+        {
+            // Unknown (e.g. variable) refresh rate or not enough data yet, paint as early as possible.
+            delay = 0;
+            return;
+        }
+
+        std::copy(paint_samples.begin(), paint_samples.begin() + nr_samples, sorted_samples.begin());
+        auto percentile = sorted_samples.begin() + (nr_samples - 1) * AUTO_PERCENTILE / 100;
+        std::nth_element(sorted_samples.begin(), percentile, sorted_samples.begin() + nr_samples);
+
+        const int64_t predicted_usec = *percentile + safety_margin_usec;
+        // Round down, so that we rather start painting a bit too early than too late.
+        delay = std::max<int64_t>(0, (refresh_usec - predicted_usec) / 1000);
+    }
+
     static constexpr int64_t MIN_INCREASE_WINDOW = 200; // 200 ms
     static constexpr int64_t MAX_INCREASE_WINDOW = 30'000; // 30s
     int64_t increase_window = MIN_INCREASE_WINDOW;
@@ -920,13 +1007,247 @@ struct repaint_delay_manager_t
     // Time of last frame
     int64_t last_pageflip = -1; // -1 is invalid
 
-    int64_t refresh_nsec;
+    int64_t refresh_nsec = 0;
+
+    static constexpr size_t AUTO_SAMPLES     = 120;
+    static constexpr size_t AUTO_MIN_SAMPLES = 10;
+    static constexpr size_t AUTO_PERCENTILE  = 95;
+    static constexpr int64_t AUTO_MIN_MARGIN_USEC   = 1'000;
+    static constexpr int64_t AUTO_MAX_MARGIN_USEC   = 8'000;
+    static constexpr int64_t AUTO_MARGIN_DECAY_USEC = 10;
+    std::array<int64_t, AUTO_SAMPLES> paint_samples;
+    std::array<int64_t, AUTO_SAMPLES> sorted_samples;
+    size_t next_sample = 0;
+    size_t nr_samples  = 0;
+    int64_t safety_margin_usec = AUTO_MIN_MARGIN_USEC;
+    int64_t last_gpu_usec = 0;
+
     wf::option_wrapper_t<int> max_render_time{"core/max_render_time"};
+    wf::option_wrapper_t<bool> max_render_time_auto{"core/max_render_time_auto"};
     wf::option_wrapper_t<bool> dynamic_delay{"workarounds/dynamic_repaint_delay"};
 
     wf::wl_listener_wrapper on_present;
 };
 
+/**
+ * output_planes_manager_t assigns parts of the scene to hardware planes (wlroots output layers), so that
+ * e.g. a video surface can be displayed on an overlay plane while the rest of the output is composited, or
+ * a fullscreen surface can be scanned out together with a small surface above it.
+ *
+ * The feature is enabled with the core/overlay_planes option. When enabled, it also takes over the classic
+ * single-surface direct scanout, which is the special case of a primary plane without overlays.
+ */
+class output_planes_manager_t : public plane_backend_t
+{
+  public:
+    static constexpr size_t MAX_OVERLAYS = 3;
+
+    output_planes_manager_t(wf::output_t *output)
+    {
+        this->output = output;
+    }
+
+    ~output_planes_manager_t()
+    {
+        for (auto& layer : layers)
+        {
+            wlr_output_layer_destroy(layer);
+        }
+    }
+
+    bool is_enabled() const
+    {
+        return enabled;
+    }
+
+    /** Whether overlay planes were used in the last committed frame. */
+    bool has_active_overlays() const
+    {
+        return !current.overlays.empty();
+    }
+
+    /**
+     * Compute a new assignment for the output.
+     *
+     * @param allowed Whether planes may be used for the next frame at all.
+     */
+    void update_assignment(const std::vector<scene::render_instance_uptr>& instances, bool allowed,
+        swapchain_damage_manager_t& damage_manager)
+    {
+        auto previous = std::move(current);
+        current = {};
+
+        candidates.clear();
+        if (allowed && enabled &&
+            scene::collect_plane_candidates_from_list(instances, output, candidates,
+                -wf::origin(output->get_layout_geometry())))
+        {
+            ensure_layers();
+            current = assign_planes(candidates, output->get_relative_geometry(), true, *this);
+        }
+
+        // The primary plane has to be repainted where overlays appeared or disappeared.
+        if (!same_overlays(previous, current))
+        {
+            for (auto& overlay : previous.overlays)
+            {
+                damage_manager.damage(overlay.geometry, true);
+            }
+
+            for (auto& overlay : current.overlays)
+            {
+                damage_manager.damage(overlay.geometry, true);
+            }
+        }
+    }
+
+    const plane_assignment_t& get_assignment() const
+    {
+        return current;
+    }
+
+    /**
+     * Scan out the output directly if the assignment does not need composition.
+     * @return true if a frame was committed.
+     */
+    bool try_commit_without_composition()
+    {
+        if (!current.primary)
+        {
+            return false;
+        }
+
+        wlr_output_state state;
+        wlr_output_state_init(&state);
+        wlr_output_state_set_buffer(&state, current.primary->buffer);
+        set_layers(state, current);
+        const bool ok = wlr_output_commit_state(output->handle, &state);
+        wlr_output_state_finish(&state);
+        if (!ok)
+        {
+            LOGC(SCANOUT, "Output ", output->to_string(), ": failed to commit plane assignment.");
+            current = {};
+            return false;
+        }
+
+        send_presentation_feedback();
+        return true;
+    }
+
+    /**
+     * Add the overlays of the current assignment to a composited frame. Layers used in previous frames which
+     * are not used anymore are disabled.
+     */
+    void apply_to_frame(wlr_output_state& state)
+    {
+        if (!layers.empty())
+        {
+            set_layers(state, current);
+        }
+    }
+
+    void send_presentation_feedback()
+    {
+        if (current.primary)
+        {
+            current.primary->instance->presentation_feedback(output);
+        }
+
+        for (auto& overlay : current.overlays)
+        {
+            overlay.instance->presentation_feedback(output);
+        }
+    }
+
+    // Implementation of plane_backend_t
+    size_t get_max_overlays() const override
+    {
+        // Overlay positions are not transformed, so support only untransformed outputs.
+        return (output->handle->transform == WL_OUTPUT_TRANSFORM_NORMAL) ? layers.size() : 0;
+    }
+
+    bool test_assignment(const plane_assignment_t& assignment) override
+    {
+        wlr_output_state state;
+        wlr_output_state_init(&state);
+        if (assignment.primary)
+        {
+            wlr_output_state_set_buffer(&state, assignment.primary->buffer);
+        }
+
+        set_layers(state, assignment);
+        bool ok = wlr_output_test_state(output->handle, &state);
+        for (size_t i = 0; i < assignment.overlays.size(); i++)
+        {
+            ok &= layer_states[i].accepted;
+        }
+
+        wlr_output_state_finish(&state);
+        return ok;
+    }
+
+  private:
+    wf::output_t *output;
+    wf::option_wrapper_t<bool> enabled{"core/overlay_planes"};
+
+    std::vector<wlr_output_layer*> layers;
+    std::vector<wlr_output_layer_state> layer_states;
+    std::vector<scene::plane_candidate_t> candidates;
+    plane_assignment_t current;
+
+    void ensure_layers()
+    {
+        while (layers.size() < MAX_OVERLAYS)
+        {
+            layers.push_back(wlr_output_layer_create(output->handle));
+        }
+    }
+
+    /** Fill the layer states for @assignment and attach them to @state. Unused layers are disabled. */
+    void set_layers(wlr_output_state& state, const plane_assignment_t& assignment)
+    {
+        const float scale = output->handle->scale;
+        layer_states.assign(layers.size(), wlr_output_layer_state{});
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            layer_states[i].layer = layers[i];
+            if (i < assignment.overlays.size())
+            {
+                auto& overlay = assignment.overlays[i];
+                layer_states[i].buffer  = overlay.buffer;
+                layer_states[i].src_box = {0, 0, (double)overlay.buffer->width,
+                    (double)overlay.buffer->height};
+                layer_states[i].dst_box = overlay.geometry * scale;
+            }
+        }
+
+        wlr_output_state_set_layers(&state, layer_states.data(), layer_states.size());
+    }
+
+    static bool same_overlays(const plane_assignment_t& a, const plane_assignment_t& b)
+    {
+        if (a.overlays.size() != b.overlays.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < a.overlays.size(); i++)
+        {
+            if ((a.overlays[i].instance != b.overlays[i].instance) ||
+                (a.overlays[i].geometry != b.overlays[i].geometry))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+static void run_render_pass_profiled(const scene::render_pass_params_t& params, uint32_t flags,
+    wf::region_t& swap_damage, render_pass_arena_t& arena, frame_profiler_t *profiler,
+    const plane_assignment_t *planes = nullptr);
+
 class wf::render_manager::impl
 {
   public:
@@ -940,6 +1261,9 @@ class wf::render_manager::impl
     std::unique_ptr<postprocessing_manager_t> postprocessing;
     std::unique_ptr<depth_buffer_manager_t> depth_buffer_manager;
     std::unique_ptr<repaint_delay_manager_t> delay_manager;
+    std::unique_ptr<frame_profiler_t> profiler;
+    std::unique_ptr<output_planes_manager_t> planes;
+    render_pass_arena_t render_arena;
 
     wf::option_wrapper_t<wf::color_t> background_color_opt;
 
@@ -950,6 +1274,12 @@ class wf::render_manager::impl
         postprocessing = std::make_unique<postprocessing_manager_t>(o);
         depth_buffer_manager = std::make_unique<depth_buffer_manager_t>();
         delay_manager = std::make_unique<repaint_delay_manager_t>(o);
+        profiler = std::make_unique<frame_profiler_t>();
+        planes   = std::make_unique<output_planes_manager_t>(o);
+        profiler->set_gpu_time_callback([=] (int64_t gpu_ns)
+        {
+            delay_manager->report_gpu_duration(gpu_ns / 1000);
+        });
 
         on_frame.set_callback([&] (void*)
         {
@@ -1038,6 +1368,14 @@ class wf::render_manager::impl
         const bool can_scanout = !output_inhibit_counter && effects->can_scanout() &&
             postprocessing->can_scanout() && wlr_output_is_direct_scanout_allowed(output->handle);
 
+        if (planes->is_enabled() || planes->has_active_overlays())
+        {
+            // The plane assignment also covers scanning out a single fullscreen surface.
+            planes->update_assignment(damage_manager->render_instances, can_scanout && env_allow_scanout,
+                *damage_manager);
+            return planes->try_commit_without_composition();
+        }
+
         if (!can_scanout || !env_allow_scanout)
         {
             return false;
@@ -1085,8 +1423,8 @@ class wf::render_manager::impl
         params.background_color = background_color_opt;
         params.reference_output = this->output;
 
-        this->swap_damage = scene::run_render_pass(params,
-            scene::RPASS_CLEAR_BACKGROUND | scene::RPASS_EMIT_SIGNALS);
+        run_render_pass_profiled(params, scene::RPASS_CLEAR_BACKGROUND | scene::RPASS_EMIT_SIGNALS,
+            this->swap_damage, render_arena, profiler.get(), &planes->get_assignment());
         swap_damage += -wf::origin(output->get_layout_geometry());
         swap_damage  = swap_damage * output->handle->scale;
         swap_damage &= damage_manager->get_wlr_damage_box();
@@ -1112,14 +1450,30 @@ class wf::render_manager::impl
      */
     void paint()
     {
+        const auto paint_start = std::chrono::steady_clock::now();
+        auto report_duration   = [&] ()
+        {
+            auto duration = std::chrono::steady_clock::now() - paint_start;
+            delay_manager->report_paint_duration(
+                std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+        };
+
+        profiler->begin_frame(delay_manager->needs_gpu_duration());
+
         /* Part 1: frame setup: query damage, etc. */
         effects->run_effects(OUTPUT_EFFECT_PRE);
+        profiler->mark(FRAME_STAGE_EFFECTS_PRE);
         effects->run_effects(OUTPUT_EFFECT_DAMAGE);
+        profiler->mark(FRAME_STAGE_EFFECTS_DAMAGE);
 
-        if (do_direct_scanout())
+        const bool scanned_out = do_direct_scanout();
+        profiler->mark(FRAME_STAGE_DIRECT_SCANOUT);
+        if (scanned_out)
         {
             // Yet another optimization: if we can directly scanout, we should
             // stop the rest of the repaint cycle.
+            profiler->end_frame(true);
+            report_duration();
             return;
         }
 
@@ -1129,17 +1483,22 @@ class wf::render_manager::impl
             // Optimization: the output doesn't need a new frame (so isn't damaged), so we can
             // just skip the whole repaint
             delay_manager->skip_frame();
+            profiler->cancel_frame();
             return;
         }
 
+        profiler->mark(FRAME_STAGE_START_FRAME);
+
         /* Part 2: call the renderer, which sets swap_damage and draws the scenegraph */
         wlr_renderer_begin_with_buffer(output->handle->renderer, next_frame->buffer);
         update_bound_output();
+        profiler->begin_gpu_timer();
         render_output();
         wlr_renderer_end(wf::get_core().renderer);
 
         /* Part 3: overlay effects */
         effects->run_effects(OUTPUT_EFFECT_OVERLAY);
+        profiler->mark(FRAME_STAGE_EFFECTS_OVERLAY);
 
         /* Part 4: finalize the scene: postprocessing effects */
         if (postprocessing->post_effects.size())
@@ -1156,6 +1515,8 @@ class wf::render_manager::impl
             OpenGL::render_end();
         }
 
+        profiler->mark(FRAME_STAGE_POST_EFFECTS);
+
         /* Part 5: render sw cursors
          * We render software cursors after everything else
          * for consistency with hardware cursor planes */
@@ -1163,12 +1524,19 @@ class wf::render_manager::impl
         wlr_renderer_begin_with_buffer(output->handle->renderer, next_frame->buffer);
         wlr_output_render_software_cursors(output->handle, swap_damage.to_pixman());
         wlr_renderer_end(wf::get_core().renderer);
+        profiler->end_gpu_timer();
         OpenGL::render_end();
+        profiler->mark(FRAME_STAGE_SW_CURSORS);
 
         /* Part 6: finalize frame: swap buffers, send frame_done, etc */
+        planes->apply_to_frame(next_frame->state);
         damage_manager->swap_buffers(std::move(next_frame), swap_damage);
+        planes->send_presentation_feedback();
         OpenGL::unbind_output(output);
         swap_damage.clear();
+        profiler->mark(FRAME_STAGE_SWAP_BUFFERS);
+        profiler->end_frame(false);
+        report_duration();
         post_paint();
     }
 
@@ -1185,30 +1553,44 @@ class wf::render_manager::impl
     }
 };
 
-wf::region_t scene::run_render_pass(
-    const render_pass_params_t& params, uint32_t flags)
+/**
+ * Same as scene::run_render_pass(), but the swap damage is stored in @swap_damage, scratch storage is taken
+ * from @arena, and the time spent gathering and executing render instructions is recorded in the given
+ * profiler (if any). Instances which are shown on overlay planes according to @planes are not rendered.
+ */
+static void run_render_pass_profiled(const scene::render_pass_params_t& params, uint32_t flags,
+    wf::region_t& swap_damage, render_pass_arena_t& arena, frame_profiler_t *profiler,
+    const plane_assignment_t *planes)
 {
-    auto accumulated_damage = params.damage;
+    auto scratch = arena.acquire();
+    auto& accumulated_damage = scratch->damage;
+    auto& instructions = scratch->instructions;
 
-    if (flags & RPASS_EMIT_SIGNALS)
+    accumulated_damage = params.damage;
+
+    if (flags & scene::RPASS_EMIT_SIGNALS)
     {
         // Emit render_pass_begin
         scene::render_pass_begin_signal ev{accumulated_damage, params.target};
         wf::get_core().emit(&ev);
     }
 
-    wf::region_t swap_damage = accumulated_damage;
+    swap_damage = accumulated_damage;
 
     // Gather instructions
-    std::vector<wf::scene::render_instruction_t> instructions;
     for (auto& inst : *params.instances)
     {
         inst->schedule_instructions(instructions,
             params.target, accumulated_damage);
     }
 
+    if (profiler)
+    {
+        profiler->mark(FRAME_STAGE_GATHER);
+    }
+
     // Clear visible background areas
-    if (flags & RPASS_CLEAR_BACKGROUND)
+    if (flags & scene::RPASS_CLEAR_BACKGROUND)
     {
         OpenGL::render_begin(params.target);
         for (const auto& rect : accumulated_damage)
@@ -1223,6 +1605,12 @@ wf::region_t scene::run_render_pass(
     // Render instances
     for (auto& instr : wf::reverse(instructions))
     {
+        if (planes && planes->is_on_overlay(instr.instance))
+        {
+            // Shown on a hardware plane above the composited content
+            continue;
+        }
+
         instr.instance->render(instr.target, instr.damage, instr.data);
         if (params.reference_output)
         {
@@ -1230,13 +1618,30 @@ wf::region_t scene::run_render_pass(
         }
     }
 
-    if (flags & RPASS_EMIT_SIGNALS)
+    if (flags & scene::RPASS_EMIT_SIGNALS)
     {
-        render_pass_end_signal end_ev;
+        scene::render_pass_end_signal end_ev;
         end_ev.target = params.target;
         wf::get_core().emit(&end_ev);
     }
 
+    if (profiler)
+    {
+        profiler->mark(FRAME_STAGE_RENDER);
+    }
+
+    arena.release(std::move(scratch));
+}
+
+wf::region_t scene::run_render_pass(
+    const render_pass_params_t& params, uint32_t flags)
+{
+    // Passes which are not the main pass of an output (plugins, transformers, workspace streams, etc.)
+    // share one arena.
+    static render_pass_arena_t shared_arena;
+
+    wf::region_t swap_damage;
+    run_render_pass_profiled(params, flags, swap_damage, shared_arena, nullptr);
     return swap_damage;
 }
 
@@ -1268,6 +1673,20 @@ void scene::compute_visibility_from_list(const std::vector<render_instance_uptr>
     region += offset;
 }
 
+bool scene::collect_plane_candidates_from_list(const std::vector<render_instance_uptr>& instances,
+    wf::output_t *output, std::vector<plane_candidate_t>& candidates, wf::point_t offset)
+{
+    for (auto& ch : instances)
+    {
+        if (!ch->collect_plane_candidates(output, candidates, offset))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 render_manager::render_manager(output_t *o) :
     pimpl(new impl(o))
 {}
@@ -1352,6 +1771,11 @@ void render_manager::set_require_depth_buffer(bool require)
 {
     return pimpl->depth_buffer_manager->set_required(require);
 }
+
+std::vector<frame_timings_t> render_manager::get_frame_timings(size_t max_frames) const
+{
+    return pimpl->profiler->get_frames(max_frames);
+}
 } // namespace wf
 
 /* End render_manager */
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <wayfire/scene-render.hpp>
+#include <memory>
+#include <vector>
+
+namespace wf
+{
+/**
+ * Scratch storage needed by a single render pass.
+ */
+struct render_pass_scratch_t
+{
+    /** The list of render instructions gathered from the render instances. */
+    std::vector<scene::render_instruction_t> instructions;
+    /** The damage which is passed (and modified) by the render instances when scheduling instructions. */
+    wf::region_t damage;
+};
+
+/**
+ * A render pass arena recycles the storage of render passes, so that repainting does not allocate a new list
+ * of instructions and new damage regions every frame.
+ *
+ * Instruction lists are cleared but keep their capacity, and damage regions are assigned instead of being
+ * created from scratch, so pixman can reuse their rectangle storage as well. Since render passes may be
+ * nested (for example, a transformer renders its children to an auxiliary buffer in the middle of the
+ * output's render pass), the arena keeps a stack of scratch buffers and each pass acquires its own.
+ */
+class render_pass_arena_t
+{
+  public:
+    /** Get a scratch buffer with an empty instruction list. */
+    std::unique_ptr<render_pass_scratch_t> acquire()
+    {
+        if (free_scratch.empty())
+        {
+            return std::make_unique<render_pass_scratch_t>();
+        }
+
+        auto scratch = std::move(free_scratch.back());
+        free_scratch.pop_back();
+        return scratch;
+    }
+
+    /** Return a scratch buffer to the arena after the render pass is done. */
+    void release(std::unique_ptr<render_pass_scratch_t> scratch)
+    {
+        if (free_scratch.size() >= MAX_FREE_SCRATCH)
+        {
+            return;
+        }
+
+        // clear() destroys the instructions, so that render instances referenced by them may be freed, but
+        // the list keeps its capacity for the next pass.
+        scratch->instructions.clear();
+        free_scratch.push_back(std::move(scratch));
+    }
+
+  private:
+    static constexpr size_t MAX_FREE_SCRATCH = 8;
+    std::vector<std::unique_ptr<render_pass_scratch_t>> free_scratch;
+};
+}
@@ -8,6 +8,7 @@
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/opengl.hpp>
 #include <set>
+#include <unordered_map>
 #include <algorithm>
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/util/log.hpp>
@@ -17,11 +18,13 @@
 #include <wayfire/scene-operations.hpp>
 
 #include "../view/view-impl.hpp"
+#include "../core/scene-priv.hpp"
 #include "wayfire/debug.hpp"
 #include "wayfire/geometry.hpp"
 #include "wayfire/nonstd/tracking-allocator.hpp"
 #include "wayfire/option-wrapper.hpp"
 #include "wayfire/scene-input.hpp"
+#include "wayfire/scene-render.hpp"
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/toplevel-view.hpp"
@@ -110,30 +113,6 @@ struct grid_size_manager_t
     }
 };
 
-static wf::scene::node_t *find_lca(wf::scene::node_t *a, wf::scene::node_t *b)
-{
-    wf::scene::node_t *iter = a;
-    std::set<wf::scene::node_t*> a_ancestors;
-    while (iter)
-    {
-        a_ancestors.insert(iter);
-        iter = iter->parent();
-    }
-
-    iter = b;
-    while (iter)
-    {
-        if (a_ancestors.count(iter))
-        {
-            return iter;
-        }
-
-        iter = iter->parent();
-    }
-
-    return nullptr;
-}
-
 static bool is_attached_to(wf::scene::node_t *a, wf::scene::node_t *root)
 {
     while (a)
@@ -149,23 +128,6 @@ static bool is_attached_to(wf::scene::node_t *a, wf::scene::node_t *root)
     return false;
 }
 
-static bool is_attached_to_scenegraph(wf::scene::node_t *a)
-{
-    return is_attached_to(a, wf::get_core().scene().get());
-}
-
-static size_t find_index_in_parent(wf::scene::node_t *x, wf::scene::node_t *parent)
-{
-    while (x->parent() != parent)
-    {
-        x = x->parent();
-    }
-
-    auto& children = parent->get_children();
-    auto it = std::find_if(children.begin(), children.end(), [&] (auto child) { return child.get() == x; });
-    return it - children.begin();
-}
-
 class workspace_set_root_node_t : public wf::scene::floating_inner_node_t
 {
     uint64_t index;
@@ -180,8 +142,86 @@ class workspace_set_root_node_t : public wf::scene::floating_inner_node_t
     {
         return "workspace-set id=" + std::to_string(index) + " " + stringify_flags();
     }
+
+    void gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+        wf::scene::damage_callback push_damage, wf::output_t *shown_on) override;
+
+    uint32_t optimize_update(uint32_t flags) override
+    {
+        // Views are added and removed all the time, regenerate only their instances.
+        return wf::scene::optimize_nested_render_instances(shared_from_this(), flags);
+    }
+};
+
+/**
+ * The render instance of a workspace set keeps the instances of its views in a sublist, so that when a view
+ * is added, removed or restacked, only the view's instances are regenerated.
+ */
+class workspace_set_root_instance_t : public wf::scene::render_instance_t
+{
+    std::shared_ptr<workspace_set_root_node_t> self;
+    std::vector<wf::scene::render_instance_uptr> children;
+    wf::scene::incremental_instances_t children_regen;
+    wf::scene::damage_callback push_damage;
+    wf::output_t *shown_on;
+
+    wf::signal::connection_t<wf::scene::node_regen_instances_signal> on_regen_instances = [=] (auto)
+    {
+        children_regen.regen_node(children, self.get(), push_damage, shown_on);
+    };
+
+  public:
+    workspace_set_root_instance_t(workspace_set_root_node_t *self, wf::scene::damage_callback push_damage,
+        wf::output_t *shown_on)
+    {
+        this->self = std::dynamic_pointer_cast<workspace_set_root_node_t>(self->shared_from_this());
+        this->push_damage = push_damage;
+        this->shown_on    = shown_on;
+
+        children_regen.regen_node(children, self, push_damage, shown_on);
+        self->connect(&on_regen_instances);
+    }
+
+    void schedule_instructions(std::vector<wf::scene::render_instruction_t>& instructions,
+        const wf::render_target_t& target, wf::region_t& damage) override
+    {
+        for (auto& ch : children)
+        {
+            ch->schedule_instructions(instructions, target, damage);
+        }
+    }
+
+    void presentation_feedback(wf::output_t *output) override
+    {
+        for (auto& ch : children)
+        {
+            ch->presentation_feedback(output);
+        }
+    }
+
+    wf::scene::direct_scanout try_scanout(wf::output_t *output) override
+    {
+        return wf::scene::try_scanout_from_list(children, output);
+    }
+
+    void compute_visibility(wf::output_t *output, wf::region_t& visible) override
+    {
+        wf::scene::compute_visibility_from_list(children, output, visible, {0, 0});
+    }
+
+    bool collect_plane_candidates(wf::output_t *output,
+        std::vector<wf::scene::plane_candidate_t>& candidates, wf::point_t offset) override
+    {
+        return wf::scene::collect_plane_candidates_from_list(children, output, candidates, offset);
+    }
 };
 
+void workspace_set_root_node_t::gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+    wf::scene::damage_callback push_damage, wf::output_t *shown_on)
+{
+    instances.push_back(std::make_unique<workspace_set_root_instance_t>(this, push_damage, shown_on));
+}
+
 std::vector<nonstd::observer_ptr<workspace_set_t>> workspace_set_t::get_all()
 {
     return tracking_allocator_t<workspace_set_t>::get().get_all();
@@ -437,11 +477,6 @@ struct workspace_set_t::impl
                 return true;
             }
 
-            if ((flags & WSET_SORT_STACKING) && !is_attached_to_scenegraph(view->get_root_node().get()))
-            {
-                return true;
-            }
-
             if (workspace && !view_visible_on(view, *workspace))
             {
                 return true;
@@ -453,20 +488,23 @@ struct workspace_set_t::impl
 
         if (flags & WSET_SORT_STACKING)
         {
-            std::sort(views.begin(), views.end(), [] (wayfire_toplevel_view a, wayfire_view b)
+            // Pick the views from the cached stacking order of all views, instead of comparing the positions
+            // of each pair of views in the scenegraph. Views which are not in the scenegraph are skipped.
+            std::unordered_map<wf::scene::node_t*, wayfire_toplevel_view> view_for_node;
+            for (auto& view : views)
+            {
+                view_for_node[view->get_root_node().get()] = view;
+            }
+
+            views.clear();
+            for (auto node : wf::scene::get_view_stacking_order())
             {
-                wf::scene::node_t *x   = a->get_root_node().get();
-                wf::scene::node_t *y   = b->get_root_node().get();
-                wf::scene::node_t *lca = find_lca(x, y);
-                wf::dassert(lca != nullptr,
-                    "LCA should always exist when the two nodes are in the scenegraph!");
-                wf::dassert((lca != x) && (lca != y), "LCA should not be equal to one of the nodes, this"
-                                                      "means nested views/dialogs have been added to the wset!");
-
-                const size_t idx_x = find_index_in_parent(x, lca);
-                const size_t idx_y = find_index_in_parent(y, lca);
-                return idx_x < idx_y;
-            });
+                auto view_it = view_for_node.find(node);
+                if (view_it != view_for_node.end())
+                {
+                    views.push_back(view_it->second);
+                }
+            }
         }
 
         return views;
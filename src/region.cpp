@@ -128,6 +128,48 @@ pixman_box32_t wf::region_t::get_extents() const
     return *pixman_region32_extents(this->unconst());
 }
 
+int wf::region_t::size() const
+{
+    return pixman_region32_n_rects(this->unconst());
+}
+
+int64_t wf::region_t::area() const
+{
+    int64_t area = 0;
+    for (auto& box : *this)
+    {
+        area += int64_t(box.x2 - box.x1) * (box.y2 - box.y1);
+    }
+
+    return area;
+}
+
+bool wf::region_t::simplify(const region_simplify_policy_t& policy)
+{
+    const int nrects = size();
+    if (nrects <= 1)
+    {
+        return false;
+    }
+
+    bool merge = (policy.max_rects > 0) && (nrects > policy.max_rects);
+    if (!merge && (policy.max_area_overhead > 0))
+    {
+        auto extents = get_extents();
+        const int64_t extents_area = int64_t(extents.x2 - extents.x1) * (extents.y2 - extents.y1);
+        merge = (extents_area <= area() * (1.0 + policy.max_area_overhead));
+    }
+
+    if (merge)
+    {
+        auto extents = get_extents();
+        pixman_region32_fini(&_region);
+        pixman_region32_init_with_extents(&_region, &extents);
+    }
+
+    return merge;
+}
+
 bool wf::region_t::contains_point(const wf::point_t& point) const
 {
     return pixman_region32_contains_point(this->unconst(),
@@ -11,6 +11,7 @@
 #include <wayfire/compositor-view.hpp>
 #include <wayfire/view-helpers.hpp>
 #include <wayfire/signal-definitions.hpp>
+#include <algorithm>
 #include <cstring>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -23,7 +24,8 @@ static void render_colored_rect(const wf::render_target_t& fb,
     OpenGL::render_rectangle({x, y, w, h}, premultiply, fb.get_orthographic_projection());
 }
 
-class wf::color_rect_view_t::color_rect_node_t : public wf::scene::floating_inner_node_t
+class wf::color_rect_view_t::color_rect_node_t : public wf::scene::floating_inner_node_t,
+    public wf::scene::opaque_region_node_t
 {
     class color_rect_render_instance_t : public wf::scene::simple_render_instance_t<color_rect_node_t>
     {
@@ -95,6 +97,34 @@ class wf::color_rect_view_t::color_rect_node_t : public wf::scene::floating_inne
             return {0, 0, 0, 0};
         }
     }
+
+    wf::region_t get_opaque_region() const override
+    {
+        auto view = _view.lock();
+        if (!view)
+        {
+            return {};
+        }
+
+        auto geometry = view->get_geometry();
+        auto border   = view->border;
+        // If the border is too wide for the rect, the border parts cover all of it.
+        wf::geometry_t inside = {geometry.x + border, geometry.y + border,
+            std::max(geometry.width - 2 * border, 0), std::max(geometry.height - 2 * border, 0)};
+
+        wf::region_t opaque;
+        if (view->_color.a >= 1.0)
+        {
+            opaque |= inside;
+        }
+
+        if (view->_border_color.a >= 1.0)
+        {
+            opaque |= wf::region_t{geometry} ^ inside;
+        }
+
+        return opaque;
+    }
 };
 
 /* Implementation of color_rect_view_t */
@@ -75,20 +75,13 @@ wf::scene::translation_node_instance_t::translation_node_instance_t(
 
 void wf::scene::translation_node_instance_t::regen_instances()
 {
-    children.clear();
     auto push_damage_child = [=] (wf::region_t child_damage)
     {
         child_damage += self->get_offset();
         push_damage(child_damage);
     };
 
-    for (auto& ch : self->get_children())
-    {
-        if (ch->is_enabled())
-        {
-            ch->gen_render_instances(children, push_damage_child, shown_on);
-        }
-    }
+    children_regen.regen_children(children, self.get(), push_damage_child, shown_on);
 }
 
 void wf::scene::translation_node_instance_t::schedule_instructions(
@@ -139,3 +132,9 @@ void wf::scene::translation_node_instance_t::compute_visibility(wf::output_t *ou
 {
     compute_visibility_from_list(children, output, visible, self->get_offset());
 }
+
+bool wf::scene::translation_node_instance_t::collect_plane_candidates(wf::output_t *output,
+    std::vector<plane_candidate_t>& candidates, wf::point_t offset)
+{
+    return collect_plane_candidates_from_list(children, output, candidates, offset + self->get_offset());
+}
@@ -342,15 +342,24 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
         // use GL_NEAREST for integer scale.
         // GL_NEAREST makes scaled text blocky instead of blurry, which looks better
         // but only for integer scale.
-        if (target.scale - floor(target.scale) < 0.001)
+        const bool integer_scale = (target.scale - floor(target.scale) < 0.001);
+        if (integer_scale)
         {
             GL_CALL(glTexParameteri(texture.target, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
         }
 
-        for (const auto& rect : region)
+        if (integer_scale && (self->current_state.transform == WL_OUTPUT_TRANSFORM_NORMAL))
         {
-            target.logic_scissor(wlr_box_from_pixman_box(rect));
-            OpenGL::draw_cached();
+            // Fragmented damage would otherwise result in one draw call per rectangle.
+            target.logic_scissor(wlr_box_from_pixman_box(region.get_extents()));
+            OpenGL::draw_cached_clipped(region);
+        } else
+        {
+            for (const auto& rect : region)
+            {
+                target.logic_scissor(wlr_box_from_pixman_box(rect));
+                OpenGL::draw_cached();
+            }
         }
 
         OpenGL::clear_cached();
@@ -407,6 +416,41 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
         }
     }
 
+    bool collect_plane_candidates(wf::output_t *output, std::vector<plane_candidate_t>& candidates,
+        wf::point_t offset) override
+    {
+        if (!self->current_state.current_buffer)
+        {
+            return true;
+        }
+
+        plane_candidate_t candidate;
+        candidate.instance = this;
+        candidate.geometry = self->get_bounding_box() + offset;
+
+        auto wlr_surf = self->surface;
+        if (wlr_surf)
+        {
+            wf::region_t non_opaque = self->get_bounding_box();
+            non_opaque ^= wf::region_t{&wlr_surf->opaque_region};
+            candidate.opaque = non_opaque.empty();
+        }
+
+        // The buffer can be put on a plane only if it needs no scaling, cropping or rotation.
+        auto buffer = self->current_state.current_buffer;
+        const auto expected_size = wf::dimensions(candidate.geometry * output->handle->scale);
+        if (wlr_surf && (wlr_surf->current.scale == output->handle->scale) &&
+            (self->current_state.transform == output->handle->transform) &&
+            !self->current_state.src_viewport &&
+            (wf::dimensions_t{buffer->width, buffer->height} == expected_size))
+        {
+            candidate.buffer = buffer;
+        }
+
+        candidates.push_back(candidate);
+        return true;
+    }
+
     void compute_visibility(wf::output_t *output, wf::region_t& visible) override
     {
         auto our_box = self->get_bounding_box();
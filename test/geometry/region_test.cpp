@@ -0,0 +1,87 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/region.hpp>
+
+static wf::region_t make_grid(int count, int size, int gap)
+{
+    wf::region_t region;
+    for (int i = 0; i < count; i++)
+    {
+        region |= wf::geometry_t{i * (size + gap), 0, size, size};
+    }
+
+    return region;
+}
+
+TEST_CASE("Region size and area")
+{
+    wf::region_t region;
+    REQUIRE(region.size() == 0);
+    REQUIRE(region.area() == 0);
+
+    region |= wf::geometry_t{0, 0, 10, 10};
+    region |= wf::geometry_t{20, 0, 10, 10};
+    REQUIRE(region.size() == 2);
+    REQUIRE(region.area() == 200);
+
+    // Overlapping boxes are not counted twice
+    region |= wf::geometry_t{5, 0, 10, 10};
+    REQUIRE(region.area() == 250);
+}
+
+TEST_CASE("Region simplification by rectangle count")
+{
+    wf::region_simplify_policy_t policy;
+    policy.max_rects = 4;
+
+    auto region = make_grid(4, 10, 100);
+    REQUIRE(!region.simplify(policy));
+    REQUIRE(region.size() == 4);
+
+    region = make_grid(5, 10, 100);
+    REQUIRE(region.simplify(policy));
+    REQUIRE(region.size() == 1);
+    auto extents = region.get_extents();
+    REQUIRE(extents.x1 == 0);
+    REQUIRE(extents.y1 == 0);
+    REQUIRE(extents.x2 == 450);
+    REQUIRE(extents.y2 == 10);
+}
+
+TEST_CASE("Region simplification by area overhead")
+{
+    wf::region_simplify_policy_t policy;
+    policy.max_area_overhead = 0.25;
+
+    // 4 boxes of 10x10 with 2px gaps: the bounding box is 46x10, 15% more than the region
+    auto region = make_grid(4, 10, 2);
+    REQUIRE(region.simplify(policy));
+    REQUIRE(region.size() == 1);
+    REQUIRE(region.area() == 460);
+
+    // Large gaps should not be merged
+    region = make_grid(4, 10, 10);
+    REQUIRE(!region.simplify(policy));
+    REQUIRE(region.size() == 4);
+}
+
+TEST_CASE("Disabled and trivial simplification")
+{
+    wf::region_simplify_policy_t disabled;
+    auto region = make_grid(100, 1, 1);
+    REQUIRE(!region.simplify(disabled));
+    REQUIRE(region.size() == 100);
+
+    wf::region_simplify_policy_t policy;
+    policy.max_rects         = 1;
+    policy.max_area_overhead = 10;
+
+    wf::region_t empty;
+    REQUIRE(!empty.simplify(policy));
+    REQUIRE(empty.empty());
+
+    wf::region_t single{wf::geometry_t{5, 5, 10, 10}};
+    REQUIRE(!single.simplify(policy));
+    REQUIRE(single.area() == 100);
+}
@@ -0,0 +1,122 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/signal-provider.hpp>
+
+struct test_signal_a
+{
+    int value = 0;
+};
+
+struct test_signal_b
+{};
+
+TEST_CASE("Signals are dispatched by type in connection order")
+{
+    wf::signal::provider_t provider;
+    std::vector<int> calls;
+
+    wf::signal::connection_t<test_signal_a> first  = [&] (test_signal_a *ev) { calls.push_back(ev->value); };
+    wf::signal::connection_t<test_signal_a> second = [&] (test_signal_a*) { calls.push_back(-1); };
+    wf::signal::connection_t<test_signal_b> other  = [&] (test_signal_b*) { calls.push_back(100); };
+
+    provider.connect(&first);
+    provider.connect(&other);
+    provider.connect(&second);
+
+    test_signal_a ev{5};
+    provider.emit(&ev);
+    REQUIRE(calls == std::vector<int>{5, -1});
+
+    calls.clear();
+    test_signal_b ev_b;
+    provider.emit(&ev_b);
+    REQUIRE(calls == std::vector<int>{100});
+
+    REQUIRE(wf::signal::get_signal_id<test_signal_a>() != wf::signal::get_signal_id<test_signal_b>());
+    REQUIRE(wf::signal::get_signal_id<test_signal_a>() == wf::signal::get_signal_id<test_signal_a>());
+}
+
+TEST_CASE("Connections may change during emission")
+{
+    wf::signal::provider_t provider;
+    std::vector<int> calls;
+
+    wf::signal::connection_t<test_signal_a> first  = [&] (test_signal_a*) { calls.push_back(1); };
+    wf::signal::connection_t<test_signal_a> third  = [&] (test_signal_a*) { calls.push_back(3); };
+    wf::signal::connection_t<test_signal_a> fourth = [&] (test_signal_a*) { calls.push_back(4); };
+    wf::signal::connection_t<test_signal_a> second = [&] (test_signal_a*)
+    {
+        calls.push_back(2);
+        third.disconnect();
+        provider.connect(&fourth);
+    };
+
+    provider.connect(&first);
+    provider.connect(&second);
+    provider.connect(&third);
+
+    test_signal_a ev;
+    provider.emit(&ev);
+    // third was disconnected before it was called, fourth was connected during the emission
+    REQUIRE(calls == std::vector<int>{1, 2});
+    REQUIRE(!third.is_connected());
+
+    calls.clear();
+    provider.emit(&ev);
+    REQUIRE(calls == std::vector<int>{1, 2, 4});
+}
+
+TEST_CASE("Disconnecting keeps the order of the remaining connections")
+{
+    wf::signal::provider_t provider;
+    std::vector<int> calls;
+    std::vector<std::unique_ptr<wf::signal::connection_t<test_signal_a>>> connections;
+
+    for (int i = 0; i < 10; i++)
+    {
+        connections.push_back(std::make_unique<wf::signal::connection_t<test_signal_a>>(
+            [&, i] (test_signal_a*) { calls.push_back(i); }));
+        provider.connect(connections.back().get());
+    }
+
+    for (int i = 0; i < 10; i += 2)
+    {
+        connections[i].reset();
+    }
+
+    test_signal_a ev;
+    provider.emit(&ev);
+    REQUIRE(calls == std::vector<int>{1, 3, 5, 7, 9});
+
+    connections[3]->disconnect();
+    connections[9].reset();
+    calls.clear();
+    provider.emit(&ev);
+    REQUIRE(calls == std::vector<int>{1, 5, 7});
+}
+
+TEST_CASE("Connections and providers disconnect automatically")
+{
+    wf::signal::connection_t<test_signal_a> conn = [&] (test_signal_a*) {};
+
+    {
+        wf::signal::provider_t provider;
+        provider.connect(&conn);
+        REQUIRE(conn.is_connected());
+    }
+
+    REQUIRE(!conn.is_connected());
+
+    wf::signal::provider_t provider;
+    int calls = 0;
+    {
+        wf::signal::connection_t<test_signal_a> temporary = [&] (test_signal_a*) { ++calls; };
+        provider.connect(&temporary);
+        provider.connect(&conn);
+    }
+
+    test_signal_a ev;
+    provider.emit(&ev);
+    REQUIRE(calls == 0);
+}
@@ -0,0 +1,156 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <functional>
+
+#include "../../src/output/plane-assignment.hpp"
+
+/**
+ * A plane backend which stands in for DRM: it has a fixed number of overlay planes and accepts or rejects
+ * assignments according to a configurable predicate.
+ */
+class test_plane_backend_t : public wf::plane_backend_t
+{
+  public:
+    size_t max_overlays = 3;
+    std::function<bool(const wf::plane_assignment_t&)> accept = [] (auto&) { return true; };
+    int nr_tests = 0;
+
+    size_t get_max_overlays() const override
+    {
+        return max_overlays;
+    }
+
+    bool test_assignment(const wf::plane_assignment_t& assignment) override
+    {
+        ++nr_tests;
+        return accept(assignment);
+    }
+};
+
+static const wf::geometry_t output_box = {0, 0, 1920, 1080};
+
+// The assignment logic never dereferences instances and buffers, so fake addresses are enough.
+static char instance_storage[16];
+static char buffer_storage[16];
+
+static wf::scene::plane_candidate_t candidate(int id, wf::geometry_t geometry, bool has_buffer, bool opaque)
+{
+    wf::scene::plane_candidate_t c;
+    c.instance = reinterpret_cast<wf::scene::render_instance_t*>(&instance_storage[id]);
+    c.buffer   = has_buffer ? reinterpret_cast<wlr_buffer*>(&buffer_storage[id]) : nullptr;
+    c.geometry = geometry;
+    c.opaque   = opaque;
+    return c;
+}
+
+TEST_CASE("Fullscreen opaque surface goes to the primary plane")
+{
+    test_plane_backend_t backend;
+    auto video = candidate(0, output_box, true, true);
+    auto wallpaper = candidate(1, output_box, false, true);
+
+    auto result = wf::assign_planes({video, wallpaper}, output_box, true, backend);
+    REQUIRE(result.primary.has_value());
+    REQUIRE(result.primary->instance == video.instance);
+    REQUIRE(result.overlays.empty());
+
+    // Without primary plane support, the video is put on an overlay instead.
+    result = wf::assign_planes({video, wallpaper}, output_box, false, backend);
+    REQUIRE(!result.primary.has_value());
+    REQUIRE(result.overlays.size() == 1);
+    REQUIRE(result.is_on_overlay(video.instance));
+}
+
+TEST_CASE("Fullscreen video with an OSD on top is not composited")
+{
+    test_plane_backend_t backend;
+    auto osd   = candidate(0, {100, 900, 1720, 100}, true, false);
+    auto video = candidate(1, output_box, true, true);
+
+    auto result = wf::assign_planes({osd, video}, output_box, true, backend);
+    REQUIRE(result.primary.has_value());
+    REQUIRE(result.primary->instance == video.instance);
+    REQUIRE(result.overlays.size() == 1);
+    REQUIRE(result.is_on_overlay(osd.instance));
+    REQUIRE(!result.is_on_overlay(video.instance));
+}
+
+TEST_CASE("Composited content above a buffer prevents promotion")
+{
+    test_plane_backend_t backend;
+    auto panel = candidate(0, {0, 0, 1920, 40}, false, true);
+    auto video = candidate(1, output_box, true, true);
+
+    auto result = wf::assign_planes({panel, video}, output_box, true, backend);
+    REQUIRE(!result.uses_planes());
+
+    // If the composited content does not overlap the buffer, the buffer can be put on an overlay.
+    auto window = candidate(1, {200, 200, 800, 600}, true, true);
+    auto background = candidate(2, output_box, false, true);
+    result = wf::assign_planes({panel, window, background}, output_box, true, backend);
+    REQUIRE(!result.primary.has_value());
+    REQUIRE(result.overlays.size() == 1);
+    REQUIRE(result.is_on_overlay(window.instance));
+}
+
+TEST_CASE("Overlays are ordered bottom to top and limited by the backend")
+{
+    test_plane_backend_t backend;
+    auto top    = candidate(0, {0, 0, 100, 100}, true, false);
+    auto middle = candidate(1, {50, 50, 100, 100}, true, false);
+    auto bottom = candidate(2, output_box, false, true);
+
+    auto result = wf::assign_planes({top, middle, bottom}, output_box, true, backend);
+    REQUIRE(result.overlays.size() == 2);
+    REQUIRE(result.overlays[0].instance == middle.instance);
+    REQUIRE(result.overlays[1].instance == top.instance);
+
+    // With a single plane, only the top candidate can be promoted: the middle one would be below composited
+    // content (the top candidate) otherwise.
+    backend.max_overlays = 1;
+    result = wf::assign_planes({top, middle, bottom}, output_box, true, backend);
+    REQUIRE(result.overlays.size() == 1);
+    REQUIRE(result.overlays[0].instance == top.instance);
+}
+
+TEST_CASE("Rejected assignments fall back to fewer planes")
+{
+    test_plane_backend_t backend;
+    auto a = candidate(0, {0, 0, 100, 100}, true, true);
+    auto b = candidate(1, {500, 500, 100, 100}, true, true);
+    auto background = candidate(2, output_box, false, true);
+
+    backend.accept = [] (const wf::plane_assignment_t& assignment)
+    {
+        return assignment.overlays.size() <= 1;
+    };
+
+    auto result = wf::assign_planes({a, b, background}, output_box, true, backend);
+    REQUIRE(result.overlays.size() == 1);
+    REQUIRE(result.is_on_overlay(a.instance));
+    REQUIRE(backend.nr_tests == 2);
+
+    backend.nr_tests = 0;
+    backend.accept   = [] (auto&) { return false; };
+    result = wf::assign_planes({a, b, background}, output_box, true, backend);
+    REQUIRE(!result.uses_planes());
+    REQUIRE(backend.nr_tests == 2);
+}
+
+TEST_CASE("Hidden and off-screen content is ignored")
+{
+    test_plane_backend_t backend;
+    auto video     = candidate(0, output_box, true, true);
+    auto hidden    = candidate(1, {10, 10, 100, 100}, false, true);
+    auto offscreen = candidate(2, {1920, 0, 100, 100}, false, true);
+
+    auto result = wf::assign_planes({offscreen, video, hidden}, output_box, true, backend);
+    REQUIRE(result.primary.has_value());
+    REQUIRE(result.primary->instance == video.instance);
+
+    // Buffers which are only partially on the output are composited.
+    auto partial = candidate(3, {1800, 0, 200, 100}, true, true);
+    auto background = candidate(4, output_box, false, true);
+    result = wf::assign_planes({partial, background}, output_box, true, backend);
+    REQUIRE(!result.uses_planes());
+}
@@ -0,0 +1,141 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/scene.hpp>
+#include <wayfire/view.hpp>
+
+/**
+ * A node which accepts input inside a box, and is either a view (in which case the box is also its bounding
+ * box) or a node without a meaningful bounding box, like an input grab.
+ */
+class box_node_t : public wf::scene::node_t, public wf::view_node_tag_t
+{
+  public:
+    box_node_t(wf::geometry_t box) : node_t(false), view_node_tag_t(nullptr), box(box)
+    {}
+
+    std::optional<wf::scene::input_node_t> find_node_at(const wf::pointf_t& at) override
+    {
+        if (box & at)
+        {
+            return wf::scene::input_node_t{this, at - wf::pointf_t{wf::origin(box)}};
+        }
+
+        return {};
+    }
+
+    wf::geometry_t get_bounding_box() override
+    {
+        return box;
+    }
+
+  private:
+    wf::geometry_t box;
+};
+
+class grab_node_t : public wf::scene::node_t
+{
+  public:
+    grab_node_t(wf::geometry_t box) : node_t(false), box(box)
+    {}
+
+    std::optional<wf::scene::input_node_t> find_node_at(const wf::pointf_t& at) override
+    {
+        if (box & at)
+        {
+            return wf::scene::input_node_t{this, at};
+        }
+
+        return {};
+    }
+
+    wf::geometry_t get_bounding_box() override
+    {
+        // Grabs typically do not report where they accept input.
+        return {0, 0, 0, 0};
+    }
+
+  private:
+    wf::geometry_t box;
+};
+
+/** Find the input node by testing the children of @parent in turn, like find_node_at() without an index. */
+static std::optional<wf::scene::input_node_t> linear_find_node_at(wf::scene::node_t *parent,
+    const wf::pointf_t& at)
+{
+    for (auto& child : parent->get_children())
+    {
+        if (!child->is_enabled())
+        {
+            continue;
+        }
+
+        if (auto result = child->find_node_at(at))
+        {
+            return result;
+        }
+    }
+
+    return {};
+}
+
+static void check_same_as_linear(wf::scene::node_t *parent)
+{
+    for (double x = -20; x <= 520; x += 2.5)
+    {
+        for (double y = -20; y <= 520; y += 2.5)
+        {
+            CAPTURE(x);
+            CAPTURE(y);
+            auto expected = linear_find_node_at(parent, {x, y});
+            auto actual   = parent->find_node_at({x, y});
+            REQUIRE(expected.has_value() == actual.has_value());
+            if (expected)
+            {
+                REQUIRE(expected->node.get() == actual->node.get());
+                REQUIRE(expected->local_coords.x == actual->local_coords.x);
+                REQUIRE(expected->local_coords.y == actual->local_coords.y);
+            }
+        }
+    }
+}
+
+TEST_CASE("Lookups through the spatial index match the linear walk")
+{
+    auto parent = std::make_shared<wf::scene::floating_inner_node_t>(false);
+    std::vector<wf::scene::node_ptr> children;
+
+    // A grab near the top which accepts input everywhere, but only in the left half.
+    children.push_back(std::make_shared<grab_node_t>(wf::geometry_t{0, 0, 250, 500}));
+    for (int i = 0; i < 12; i++)
+    {
+        // Overlapping views, so that the z-order matters.
+        children.push_back(std::make_shared<box_node_t>(wf::geometry_t{i * 30, i * 25, 200, 150}));
+    }
+
+    // Views which are fully covered, and an empty view.
+    children.push_back(std::make_shared<box_node_t>(wf::geometry_t{40, 40, 50, 50}));
+    children.push_back(std::make_shared<box_node_t>(wf::geometry_t{100, 100, 0, 0}));
+    // A grab at the bottom which accepts input in the whole area.
+    children.push_back(std::make_shared<grab_node_t>(wf::geometry_t{-20, -20, 560, 560}));
+    parent->set_children_list(children);
+
+    // Disable a few views, including the topmost one at some points.
+    children[1]->set_enabled(false);
+    children[5]->set_enabled(false);
+
+    SUBCASE("With the grabs")
+    {
+        // The first lookup builds the index, the others go through it.
+        check_same_as_linear(parent.get());
+        check_same_as_linear(parent.get());
+    }
+
+    SUBCASE("Without the grabs")
+    {
+        children.erase(children.begin());
+        children.pop_back();
+        parent->set_children_list(children);
+        check_same_as_linear(parent.get());
+    }
+}
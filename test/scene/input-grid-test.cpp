@@ -0,0 +1,67 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "../../src/core/input-grid.hpp"
+
+static std::vector<uint32_t> candidates(const wf::scene::input_grid_t& grid, wf::pointf_t point)
+{
+    std::vector<uint32_t> result;
+    grid.for_each_candidate(point, [&] (uint32_t idx)
+    {
+        result.push_back(idx);
+        return false;
+    });
+
+    return result;
+}
+
+TEST_CASE("Grid finds the boxes containing a point in order")
+{
+    wf::scene::input_grid_t grid{{
+        wf::geometry_t{100, 100, 200, 200},
+        wf::geometry_t{0, 0, 1920, 1080},
+        wf::geometry_t{150, 150, 50, 50},
+        wf::geometry_t{1000, 500, 300, 300},
+    }};
+
+    REQUIRE(candidates(grid, {160, 160}) == std::vector<uint32_t>{0, 1, 2});
+    REQUIRE(candidates(grid, {120.5, 110}) == std::vector<uint32_t>{0, 1});
+    REQUIRE(candidates(grid, {1100, 600}) == std::vector<uint32_t>{1, 3});
+    REQUIRE(candidates(grid, {1500, 50}) == std::vector<uint32_t>{1});
+    REQUIRE(candidates(grid, {-10, 50}).empty());
+    REQUIRE(candidates(grid, {1950, 50}).empty());
+}
+
+TEST_CASE("Unbounded boxes are candidates for every point")
+{
+    wf::scene::input_grid_t grid{{
+        std::nullopt,
+        wf::geometry_t{0, 0, 100, 100},
+        std::nullopt,
+        wf::geometry_t{50, 50, 100, 100},
+        wf::geometry_t{10, 10, 0, 0},
+    }};
+
+    REQUIRE(candidates(grid, {75, 75}) == std::vector<uint32_t>{0, 1, 2, 3});
+    REQUIRE(candidates(grid, {10, 10}) == std::vector<uint32_t>{0, 1, 2});
+    REQUIRE(candidates(grid, {-5000, 5000}) == std::vector<uint32_t>{0, 2});
+}
+
+TEST_CASE("Grid stops at the first accepted candidate")
+{
+    wf::scene::input_grid_t grid{{
+        wf::geometry_t{0, 0, 100, 100},
+        wf::geometry_t{0, 0, 100, 100},
+    }};
+
+    int nr_calls = 0;
+    REQUIRE(grid.for_each_candidate({50, 50}, [&] (uint32_t idx)
+    {
+        ++nr_calls;
+        return idx == 0;
+    }));
+    REQUIRE(nr_calls == 1);
+
+    wf::scene::input_grid_t empty{std::vector<std::optional<wf::geometry_t>>{}};
+    REQUIRE(!empty.for_each_candidate({50, 50}, [&] (uint32_t) { return true; }));
+}
@@ -0,0 +1,81 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <wayfire/scene.hpp>
+#include <wayfire/scene-render.hpp>
+#include <wayfire/unstable/translation-node.hpp>
+#include "../../src/core/core-impl.hpp"
+
+/**
+ * A leaf node which counts how many times its render instances were generated.
+ */
+class counting_node_t : public wf::scene::node_t
+{
+  public:
+    int *nr_generated;
+
+    counting_node_t(int *nr_generated) : node_t(false), nr_generated(nr_generated)
+    {}
+
+    void gen_render_instances(std::vector<wf::scene::render_instance_uptr>& instances,
+        wf::scene::damage_callback push_damage, wf::output_t *output) override
+    {
+        ++*nr_generated;
+        node_t::gen_render_instances(instances, push_damage, output);
+    }
+};
+
+TEST_CASE("Adding a child to a nested node regenerates only the new child's instances")
+{
+    // update() checks for the scenegraph root, which is null without a fully initialized core.
+    static auto& core = wf::compositor_core_impl_t::allocate_core();
+    (void)core;
+
+    int nr_generated = 0;
+    auto outer = std::make_shared<wf::scene::translation_node_t>(false);
+    auto inner = std::make_shared<wf::scene::translation_node_t>(false);
+    auto plain = std::make_shared<wf::scene::floating_inner_node_t>(false);
+    std::vector<wf::scene::node_ptr> leaves;
+    for (int i = 0; i < 3; i++)
+    {
+        leaves.push_back(std::make_shared<counting_node_t>(&nr_generated));
+    }
+
+    inner->set_children_list({leaves[0], leaves[1], leaves[2]});
+    plain->set_children_list({std::make_shared<counting_node_t>(&nr_generated)});
+    outer->set_children_list({inner, plain});
+
+    std::vector<wf::scene::render_instance_uptr> instances;
+    outer->gen_render_instances(instances, [] (const wf::region_t&) {}, nullptr);
+    REQUIRE(nr_generated == 4);
+
+    SUBCASE("Node which handles its own children")
+    {
+        const uint64_t serial = inner->get_instances_serial();
+        auto children = inner->get_children();
+        children.insert(children.begin(), std::make_shared<counting_node_t>(&nr_generated));
+        inner->set_children_list(children);
+        wf::scene::update(inner, wf::scene::update_flag::CHILDREN_LIST);
+
+        REQUIRE(nr_generated == 5);
+        REQUIRE(inner->get_instances_serial() == serial);
+    }
+
+    SUBCASE("Node which needs new instances from its parent")
+    {
+        auto children = plain->get_children();
+        children.push_back(std::make_shared<counting_node_t>(&nr_generated));
+        plain->set_children_list(children);
+        wf::scene::update(plain, wf::scene::update_flag::CHILDREN_LIST);
+
+        // The parent regenerates the whole subtree of the changed node, but not its siblings.
+        REQUIRE(nr_generated == 6);
+    }
+
+    SUBCASE("Removing a child regenerates nothing")
+    {
+        inner->set_children_list({leaves[0], leaves[2]});
+        wf::scene::update(inner, wf::scene::update_flag::CHILDREN_LIST);
+        REQUIRE(nr_generated == 4);
+    }
+}
@@ -0,0 +1,133 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "../../src/core/txn/frame-sync.hpp"
+
+/**
+ * A frame sync with fake outputs: the outputs are only compared by address, so any distinct pointers will do.
+ */
+class test_frame_sync_t : public wf::txn::frame_sync_t
+{
+  public:
+    std::set<wf::output_t*> next_outputs;
+    std::set<wf::output_t*> stopped;
+    std::set<wf::output_t*> requested;
+
+  protected:
+    std::set<wf::output_t*> find_affected_outputs(wf::txn::transaction_t*) override
+    {
+        return next_outputs;
+    }
+
+    bool is_producing_frames(wf::output_t *output) override
+    {
+        return !stopped.count(output);
+    }
+
+    void request_frame(wf::output_t *output) override
+    {
+        requested.insert(output);
+    }
+
+    void cancel_frame_request(wf::output_t *output) override
+    {
+        requested.erase(output);
+    }
+};
+
+static int fake_outputs[2];
+static wf::output_t *const output_a = reinterpret_cast<wf::output_t*>(&fake_outputs[0]);
+static wf::output_t *const output_b = reinterpret_cast<wf::output_t*>(&fake_outputs[1]);
+
+TEST_CASE("Transactions are applied on the next frame of an affected output")
+{
+    test_frame_sync_t sync;
+    std::vector<int> applied;
+
+    sync.next_outputs = {output_a};
+    sync.schedule_apply(nullptr, [&] { applied.push_back(1); });
+    sync.next_outputs = {output_a, output_b};
+    sync.schedule_apply(nullptr, [&] { applied.push_back(2); });
+    REQUIRE(applied.empty());
+    REQUIRE(sync.requested == std::set<wf::output_t*>{output_a, output_b});
+
+    sync.apply_for_output(output_b);
+    REQUIRE(applied == std::vector<int>{2});
+    REQUIRE(sync.requested == std::set<wf::output_t*>{output_a});
+
+    sync.apply_for_output(output_a);
+    REQUIRE(applied == std::vector<int>{2, 1});
+    REQUIRE(sync.requested.empty());
+}
+
+TEST_CASE("Transactions without visible changes are applied immediately")
+{
+    test_frame_sync_t sync;
+    int applied = 0;
+
+    sync.schedule_apply(nullptr, [&] { ++applied; });
+    REQUIRE(applied == 1);
+    REQUIRE(sync.requested.empty());
+}
+
+TEST_CASE("Outputs which do not produce frames are not waited for")
+{
+    test_frame_sync_t sync;
+    int applied = 0;
+
+    sync.stopped = {output_a};
+    sync.next_outputs = {output_a};
+    sync.schedule_apply(nullptr, [&] { ++applied; });
+    REQUIRE(applied == 1);
+    REQUIRE(sync.requested.empty());
+
+    sync.next_outputs = {output_a, output_b};
+    sync.schedule_apply(nullptr, [&] { ++applied; });
+    REQUIRE(applied == 1);
+    REQUIRE(sync.requested == std::set<wf::output_t*>{output_b});
+
+    sync.apply_for_output(output_b);
+    REQUIRE(applied == 2);
+}
+
+TEST_CASE("Transactions are applied when their outputs stop producing frames")
+{
+    test_frame_sync_t sync;
+    std::vector<int> applied;
+
+    sync.next_outputs = {output_a};
+    sync.schedule_apply(nullptr, [&] { applied.push_back(1); });
+    sync.next_outputs = {output_a, output_b};
+    sync.schedule_apply(nullptr, [&] { applied.push_back(2); });
+
+    sync.stopped = {output_a};
+    sync.check_stopped_outputs();
+    REQUIRE(applied == std::vector<int>{1});
+    REQUIRE(sync.requested == std::set<wf::output_t*>{output_b});
+
+    sync.stopped = {output_a, output_b};
+    sync.check_stopped_outputs();
+    REQUIRE(applied == std::vector<int>{1, 2});
+    REQUIRE(sync.requested.empty());
+}
+
+TEST_CASE("Transactions deferred while applying wait for the next frame")
+{
+    test_frame_sync_t sync;
+    int applied = 0;
+
+    sync.next_outputs = {output_a};
+    sync.schedule_apply(nullptr, [&]
+    {
+        ++applied;
+        sync.schedule_apply(nullptr, [&] { ++applied; });
+    });
+
+    sync.apply_for_output(output_a);
+    REQUIRE(applied == 1);
+    REQUIRE(sync.requested == std::set<wf::output_t*>{output_a});
+
+    sync.apply_for_output(output_a);
+    REQUIRE(applied == 2);
+    REQUIRE(sync.requested.empty());
+}
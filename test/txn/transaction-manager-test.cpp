@@ -290,3 +290,158 @@ TEST_CASE("Concurrent committed")
     REQUIRE(mgr.pending.size() == 0);
     REQUIRE(mgr.done.size() == 2);
 }
+
+TEST_CASE("Batched transactions are applied atomically")
+{
+    setup_wayfire_debugging_state();
+    wf::txn::transaction_manager_t mgr;
+
+    auto a = std::make_shared<txn_test_object_t>(false);
+    auto b = std::make_shared<txn_test_object_t>(false);
+
+    mgr.begin_batch();
+    auto tx1 = new_tx();
+    tx1->add_object(a);
+    mgr.schedule_transaction(std::move(tx1));
+
+    // Nested batches are merged into the outermost one
+    mgr.begin_batch();
+    auto tx2 = new_tx();
+    tx2->add_object(b);
+    mgr.schedule_transaction(std::move(tx2));
+    mgr.end_batch();
+
+    REQUIRE(mgr.priv->pending.size() == 0);
+    REQUIRE(mgr.priv->committed.size() == 0);
+    REQUIRE(a->number_committed == 0);
+
+    mgr.end_batch();
+    REQUIRE(mgr.priv->committed.size() == 1);
+    REQUIRE(mgr.priv->committed.front()->get_objects().size() == 2);
+    REQUIRE(a->number_committed == 1);
+    REQUIRE(b->number_committed == 1);
+
+    a->emit_ready();
+    REQUIRE(a->number_applied == 0);
+    b->emit_ready();
+    REQUIRE(a->number_applied == 1);
+    REQUIRE(b->number_applied == 1);
+}
+
+TEST_CASE("Transactions connected through a new transaction are merged")
+{
+    setup_wayfire_debugging_state();
+    wf::txn::transaction_manager_t::impl mgr;
+
+    auto obj_a = std::make_shared<txn_test_object_t>(false);
+    auto obj_b = std::make_shared<txn_test_object_t>(false);
+    auto obj_c = std::make_shared<txn_test_object_t>(false);
+    auto obj_d = std::make_shared<txn_test_object_t>(false);
+    auto obj_e = std::make_shared<txn_test_object_t>(false);
+
+    // Block a, b, c and d, so that the following transactions stay pending
+    auto blocker = new_tx();
+    blocker->add_object(obj_a);
+    blocker->add_object(obj_b);
+    blocker->add_object(obj_c);
+    blocker->add_object(obj_d);
+    mgr.schedule_transaction(std::move(blocker));
+
+    auto tx_ab = new_tx();
+    tx_ab->add_object(obj_a);
+    tx_ab->add_object(obj_b);
+    mgr.schedule_transaction(std::move(tx_ab));
+
+    auto tx_cd = new_tx();
+    tx_cd->add_object(obj_c);
+    tx_cd->add_object(obj_d);
+    mgr.schedule_transaction(std::move(tx_cd));
+
+    auto tx_e = new_tx();
+    tx_e->add_object(obj_e);
+    mgr.schedule_transaction(std::move(tx_e));
+
+    REQUIRE(mgr.pending.size() == 2);
+    REQUIRE(mgr.committed.size() == 2);
+    REQUIRE(obj_e->number_committed == 1);
+
+    // b and c connect both pending transactions
+    auto tx_bc = new_tx();
+    tx_bc->add_object(obj_b);
+    tx_bc->add_object(obj_c);
+    mgr.schedule_transaction(std::move(tx_bc));
+
+    REQUIRE(mgr.pending.size() == 1);
+    REQUIRE(mgr.pending.front()->get_objects().size() == 4);
+    REQUIRE(mgr.pending_objects.size() == 4);
+    REQUIRE(mgr.pending_objects.at(obj_a.get()) == mgr.pending.front().get());
+    REQUIRE(mgr.pending_objects.at(obj_d.get()) == mgr.pending.front().get());
+    REQUIRE(mgr.committed_objects.size() == 5);
+
+    obj_a->emit_ready();
+    obj_b->emit_ready();
+    obj_c->emit_ready();
+    obj_d->emit_ready();
+    REQUIRE(mgr.pending.size() == 0);
+    REQUIRE(mgr.pending_objects.empty());
+    REQUIRE(mgr.committed.size() == 2);
+    REQUIRE(mgr.committed_objects.size() == 5);
+    REQUIRE(obj_a->number_committed == 2);
+    REQUIRE(obj_d->number_committed == 2);
+}
+
+TEST_CASE("Object index stays consistent with many objects")
+{
+    setup_wayfire_debugging_state();
+    wf::txn::transaction_manager_t::impl mgr;
+
+    // Similar to tiling a workspace: each view gets its own transaction, then all views are rearranged at
+    // once while the first transactions are still in flight.
+    const int nr_objects = 30;
+    std::vector<std::shared_ptr<txn_test_object_t>> objects;
+    for (int i = 0; i < nr_objects; i++)
+    {
+        objects.push_back(std::make_shared<txn_test_object_t>(false));
+        auto tx = new_tx();
+        tx->add_object(objects.back());
+        mgr.schedule_transaction(std::move(tx));
+    }
+
+    REQUIRE(mgr.committed.size() == nr_objects);
+    REQUIRE(mgr.committed_objects.size() == nr_objects);
+
+    for (int i = 0; i + 1 < nr_objects; i++)
+    {
+        auto tx = new_tx();
+        tx->add_object(objects[i]);
+        tx->add_object(objects[i + 1]);
+        mgr.schedule_transaction(std::move(tx));
+    }
+
+    REQUIRE(mgr.pending.size() == 1);
+    REQUIRE(mgr.pending.front()->get_objects().size() == nr_objects);
+    REQUIRE(mgr.pending_objects.size() == nr_objects);
+
+    for (auto& obj : objects)
+    {
+        obj->emit_ready();
+    }
+
+    REQUIRE(mgr.pending.size() == 0);
+    REQUIRE(mgr.pending_objects.empty());
+    REQUIRE(mgr.committed.size() == 1);
+    REQUIRE(mgr.committed_objects.size() == nr_objects);
+
+    for (auto& obj : objects)
+    {
+        REQUIRE(obj->number_applied == 1);
+        obj->emit_ready();
+    }
+
+    REQUIRE(mgr.committed.size() == 0);
+    REQUIRE(mgr.committed_objects.empty());
+    for (auto& obj : objects)
+    {
+        REQUIRE(obj->number_applied == 2);
+    }
+}
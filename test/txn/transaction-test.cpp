@@ -8,6 +8,7 @@
 
 #include "transaction-test-object.hpp"
 #include <wayfire/txn/transaction.hpp>
+#include <wayfire/txn/transaction-stats.hpp>
 
 static void run_transaction_test(bool timeout, bool autoready)
 {
@@ -99,3 +100,112 @@ TEST_CASE("Transaction is applied immediately if all objects are ready")
 {
     run_transaction_test(false, true);
 }
+
+TEST_CASE("Transaction latencies and late objects are recorded")
+{
+    setup_wayfire_debugging_state();
+    wf::txn::reset_transaction_stats();
+
+    wf::wl_timer<false>::callback_t tx_timeout_callback;
+    wf::txn::transaction_t tx(1234, [&] (uint64_t, wf::wl_timer<false>::callback_t cb)
+    {
+        tx_timeout_callback = cb;
+    });
+
+    auto object1 = std::make_shared<txn_test_object_t>(false);
+    auto object2 = std::make_shared<txn_test_object_t>(false);
+    tx.add_object(object1);
+    tx.add_object(object2);
+    tx.commit();
+
+    object1->emit_ready();
+    tx_timeout_callback();
+
+    REQUIRE(tx.get_trace().ready.count(object1.get()));
+    REQUIRE(!tx.get_trace().ready.count(object2.get()));
+
+    auto stats = wf::txn::get_transaction_stats();
+    REQUIRE(stats.applied == 1);
+    REQUIRE(stats.timed_out == 1);
+    REQUIRE(stats.commit_to_apply.count == 1);
+    REQUIRE(stats.object_types.size() == 1);
+    REQUIRE(stats.object_types[0].ready_latency.count == 2);
+    REQUIRE(stats.object_types[0].timeouts == 1);
+    REQUIRE(stats.recent_timeouts.size() == 1);
+    REQUIRE(stats.recent_timeouts[0].late_objects == std::vector<std::string>{object2->stringify()});
+
+    wf::txn::reset_transaction_stats();
+    REQUIRE(wf::txn::get_transaction_stats().applied == 0);
+}
+
+TEST_CASE("Latency histogram buckets")
+{
+    wf::txn::latency_histogram_t histogram;
+    histogram.add(0);
+    histogram.add(999);
+    histogram.add(1000);
+    histogram.add(3000);
+    histogram.add(10'000'000);
+
+    REQUIRE(histogram.buckets[0] == 2);
+    REQUIRE(histogram.buckets[1] == 1);
+    REQUIRE(histogram.buckets[2] == 1);
+    REQUIRE(histogram.buckets[wf::txn::latency_histogram_t::NR_BUCKETS - 1] == 1);
+    REQUIRE(histogram.count == 5);
+    REQUIRE(histogram.max_us == 10'000'000);
+}
+
+TEST_CASE("Apply scheduler defers applying ready transactions")
+{
+    setup_wayfire_debugging_state();
+    wf::wl_timer<false>::callback_t tx_timeout_callback;
+    auto timer_setter = [&] (uint64_t, wf::wl_timer<false>::callback_t cb)
+    {
+        tx_timeout_callback = cb;
+    };
+
+    std::vector<std::function<void()>> deferred;
+    auto scheduler = [&] (wf::txn::transaction_t*, std::function<void()> apply)
+    {
+        deferred.push_back(apply);
+    };
+
+    auto object = std::make_shared<txn_test_object_t>(true);
+    {
+        wf::txn::transaction_t tx(1234, timer_setter);
+        tx.set_apply_scheduler(scheduler);
+        tx.add_object(object);
+        tx.commit();
+
+        REQUIRE(object->number_committed == 1);
+        REQUIRE(object->number_applied == 0);
+        REQUIRE(deferred.size() == 1);
+
+        deferred[0]();
+        REQUIRE(object->number_applied == 1);
+
+        // Neither the timeout nor a second deferred call apply the transaction again.
+        tx_timeout_callback();
+        deferred[0]();
+        REQUIRE(object->number_applied == 1);
+    }
+
+    // A timeout applies the transaction even if the deferred apply did not happen yet.
+    deferred.clear();
+    {
+        wf::txn::transaction_t tx(1234, timer_setter);
+        tx.set_apply_scheduler(scheduler);
+        tx.add_object(object);
+        tx.commit();
+        REQUIRE(deferred.size() == 1);
+
+        tx_timeout_callback();
+        REQUIRE(object->number_applied == 2);
+        deferred[0]();
+        REQUIRE(object->number_applied == 2);
+    }
+
+    // The deferred apply is a no-op once the transaction is destroyed.
+    deferred[0]();
+    REQUIRE(object->number_applied == 2);
+}
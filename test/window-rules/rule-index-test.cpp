@@ -0,0 +1,105 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <map>
+
+#include "../../plugins/window-rules/rule-index.hpp"
+
+/**
+ * Build an index from the given rules, in order.
+ */
+static wf::rule_index_t make_index(const std::vector<std::string>& rules)
+{
+    wf::rule_index_t index;
+    for (size_t i = 0; i < rules.size(); i++)
+    {
+        index.add(i, rules[i]);
+    }
+
+    return index;
+}
+
+static std::vector<size_t> candidates(const wf::rule_index_t& index, const std::string& signal,
+    const std::map<std::string, std::string>& attributes)
+{
+    std::vector<size_t> result;
+    index.get_candidates(signal, [&] (const std::string& attribute) -> std::optional<std::string>
+    {
+        auto it = attributes.find(attribute);
+        if (it == attributes.end())
+        {
+            return {};
+        }
+
+        return it->second;
+    }, result);
+
+    return result;
+}
+
+TEST_CASE("Rules are keyed by signal, app_id and type")
+{
+    auto index = make_index({
+        R"(on created if app_id is "firefox" then maximize)",
+        R"(on created if type is "toplevel" & title contains "x" then minimize)",
+        R"(on maximized if app_id is "firefox" then set alpha 0.5)",
+        R"(on created if title is "a" & app_id is "kitty" then maximize)",
+    });
+
+    REQUIRE(candidates(index, "created", {{"app_id", "firefox"}, {"type", "toplevel"}}) ==
+        std::vector<size_t>{0, 1});
+    REQUIRE(candidates(index, "created", {{"app_id", "kitty"}, {"type", "x-or"}}) == std::vector<size_t>{3});
+    REQUIRE(candidates(index, "maximized", {{"app_id", "firefox"}, {"type", "toplevel"}}) ==
+        std::vector<size_t>{2});
+    REQUIRE(candidates(index, "minimized", {{"app_id", "firefox"}, {"type", "toplevel"}}).empty());
+}
+
+TEST_CASE("Unknown attribute values keep the keyed rules")
+{
+    auto index = make_index({
+        R"(on created if app_id is "firefox" then maximize)",
+        R"(on created if app_id is "kitty" then maximize)",
+    });
+
+    REQUIRE(candidates(index, "created", {}) == std::vector<size_t>{0, 1});
+}
+
+TEST_CASE("Rules which are not understood are always candidates")
+{
+    const std::vector<std::string> rules = {
+        R"(on created if app_id is "firefox" then maximize else minimize)",
+        R"(on created if app_id is "firefox" | app_id is "kitty" then maximize)",
+        R"(on created if !app_id is "firefox" then maximize)",
+        R"(on created if (app_id is "firefox") then maximize)",
+        R"(on created if app_id is "fire\"fox" then maximize)",
+        R"(if app_id is "firefox" then maximize)",
+        R"(on created if app_id is "firefox then maximize)",
+    };
+
+    for (size_t i = 0; i < rules.size(); i++)
+    {
+        CAPTURE(rules[i]);
+        auto index = make_index({rules[i]});
+        REQUIRE(candidates(index, "created", {{"app_id", "other"}, {"type", "toplevel"}}) ==
+            std::vector<size_t>{0});
+    }
+
+    // Rules without a signal are candidates for all signals, the others only for their own signal.
+    auto index = make_index({rules[0], rules[5]});
+    REQUIRE(candidates(index, "minimized", {{"app_id", "other"}}) == std::vector<size_t>{1});
+}
+
+TEST_CASE("Candidates stay in the order of the rules")
+{
+    auto index = make_index({
+        R"(on created if type is "toplevel" then maximize)",
+        R"(if app_id is "firefox" then minimize)",
+        R"(on created if app_id is "firefox" then set alpha 0.5)",
+        R"(on created if app_id is "firefox" | type is "x" then maximize)",
+        R"(on created if type is "toplevel" & app_id is "firefox" then minimize)",
+    });
+
+    REQUIRE(candidates(index, "created", {{"app_id", "firefox"}, {"type", "toplevel"}}) ==
+        std::vector<size_t>{0, 1, 2, 3, 4});
+    REQUIRE(candidates(index, "created", {{"app_id", "kitty"}, {"type", "toplevel"}}) ==
+        std::vector<size_t>{0, 1, 3, 4});
+}